@@ -0,0 +1,107 @@
+// Measures how fast the streaming server of 'plotlib_start_server' stages samples from a Unix domain socket.
+// Build it next to libplotlib.so (from ./build_shared_lib.sh) and run it from the project directory:
+//   g++ -O2 bench/stream_bench.cpp -o stream_bench -L. -lplotlib -Wl,-rpath,. -lpthread && ./stream_bench
+// The sender runs on a thread of this process. After the samples it appends one value to a marker plot; the frames of a
+// connection are staged in order, so the samples are all staged once the marker plot has staged bytes. The window stays
+// hidden and the samples plot drops its oldest staged values beyond 2^22, so the memory stays bounded.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../plotlib.h"
+
+#define SOCKET_PATH "/tmp/plotlib_stream_bench.sock"
+#define SAMPLES_PLOT 1
+#define FIRST_MARKER_PLOT 2 // every run uses a new one, as the staging buffers of a used plot keep their capacity
+#define SAMPLES_PER_RUN ((uint64_t) 1 << 26)
+
+static bool send_all(int fd, const void* data, size_t size)
+{
+    const char* bytes = (const char*) data;
+    while (size > 0) {
+        ssize_t sent = send(fd, bytes, size, 0);
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+// Frames of 'frame_length' samples of 'sample_size' bytes.
+// The payload is padded to a multiple of 8 bytes.
+static std::vector<uint8_t> make_frame(uint32_t plot_idx, uint16_t sample_type, uint64_t sample_size, uint64_t frame_length)
+{
+    plotlib_frame_header header = { plot_idx, PLOTLIB_FRAME_APPEND_NUMBERS, sample_type, frame_length };
+    uint64_t payload_size = (frame_length * sample_size + 7) / 8 * 8;
+    std::vector<uint8_t> frame(sizeof(header) + payload_size, 0);
+    memcpy(frame.data(), &header, sizeof(header));
+    for (uint64_t i = 0; i < frame_length * sample_size; ++i) {
+        frame[sizeof(header) + i] = (uint8_t) (i * 31);
+    }
+    return frame;
+}
+
+static double run(uint16_t sample_type, uint64_t sample_size, uint64_t frame_length, uint32_t marker_plot)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, SOCKET_PATH, sizeof(address.sun_path) - 1);
+    if (fd < 0 || connect(fd, (sockaddr*) &address, sizeof(address)) != 0) {
+        printf("Failed to connect to '%s'.\n", SOCKET_PATH);
+        return 0;
+    }
+
+    std::vector<uint8_t> frame = make_frame(SAMPLES_PLOT, sample_type, sample_size, frame_length);
+    std::vector<uint8_t> marker = make_frame(marker_plot, PLOTLIB_SAMPLE_F64, sizeof(double), 1);
+
+    auto begin = std::chrono::steady_clock::now();
+    std::thread sender([&] {
+        for (uint64_t sent = 0; sent < SAMPLES_PER_RUN; sent += frame_length) {
+            if (!send_all(fd, frame.data(), frame.size())) return;
+        }
+        send_all(fd, marker.data(), marker.size());
+    });
+    plotlib_memory_usage usage = {};
+    while (plot_get_memory_usage(marker_plot, &usage) && usage.staged_bytes == 0) {
+        std::this_thread::yield();
+    }
+    auto end = std::chrono::steady_clock::now();
+    sender.join();
+    close(fd);
+
+    return SAMPLES_PER_RUN / std::chrono::duration<double>(end - begin).count();
+}
+
+int main()
+{
+    if (!plotlib_start_server(SOCKET_PATH)) return 1;
+    plot_set_staging_limit(SAMPLES_PLOT, PLOTLIB_STAGING_DROP_OLDEST, (uint64_t) 1 << 22);
+
+    struct { const char* name; uint16_t sample_type; uint64_t sample_size; } types[] = {
+        { "float64", PLOTLIB_SAMPLE_F64, 8 },
+        { "float32", PLOTLIB_SAMPLE_F32, 4 },
+        { "int16", PLOTLIB_SAMPLE_I16, 2 },
+    };
+    uint64_t frame_lengths[] = { 64, 4096 };
+    uint32_t marker_plot = FIRST_MARKER_PLOT;
+
+    printf("%-8s %14s %16s\n", "type", "frame samples", "M samples/s");
+    for (uint64_t frame_length : frame_lengths) {
+        for (auto& type : types) {
+            double samples_per_second = run(type.sample_type, type.sample_size, frame_length, marker_plot++);
+            printf("%-8s %14llu %16.1f\n", type.name, (unsigned long long) frame_length, samples_per_second / 1e6);
+        }
+    }
+
+    plotlib_stop_server();
+    return 0;
+}
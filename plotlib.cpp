@@ -6,12 +6,42 @@
 #include <cstdio>
 #include <cassert>
 #include <cmath>
+#include <ctime>
 
 #include <limits>
+#include <charconv>
+#include <string>
 #include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <atomic>
 #include <mutex>
+#include <condition_variable>
 #include <thread>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HAS_SSE2
+#endif
+
+#if defined(HAS_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAS_AVX_DISPATCH // the AVX kernels are compiled for their target and chosen at runtime
+#endif
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
 namespace rl {
 #include "raylib/raylib.h"
 }
@@ -40,24 +70,48 @@ namespace rl {
 
 #define INVALID_IDX ((uint32_t)~0) // Max uint32 value
 
-#define MAX_PLOT_SIZE (PLOTLIB_MAX_PLOT_IDX + 1)
+#define MAX_PLOT_SIZE (PLOTLIB_MAX_PLOT_IDX + 1) // the fixed plot indices, 'plot_create' hands out the ones after them
+#define MAX_PLOT_HANDLE_COUNT (PLOTLIB_MAX_PLOT_HANDLE + 1)
+#define PLOT_PAGE_LENGTH 256 // plots whose state is allocated at once
 #define MAX_PLOT_GROUP_SIZE (PLOTLIB_MAX_PLOT_GROUP_IDX + 2)
 #define DEFAULT_PLOT_GROUP_IDX (PLOTLIB_MAX_PLOT_GROUP_IDX + 1)
 
 #define MAX_TICK_MARK_TEXT_LENGTH 30
 #define MAX_TICK_MARK_COUNT 32
 
+#define CACHE_LINE_SIZE 64
+#define NANOSECONDS_PER_SECOND 1000000000
+#define SECONDS_PER_DAY 86400
+#define NO_TIME_ORIGIN INT64_MIN
+#define MAX_TIME_AXIS_SECONDS 9e9 // x values of a time axis beyond this (about 285 years) aren't labeled as times
+#define READ_BLOCK_LENGTH 1024 // values which are decoded at once when reading encoded samples
+#define BOUNDS_BLOCK_LENGTH 4096 // values per block whose bounds are kept for plots with a retention
+#define CHUNK_SHIFT 16
+#define CHUNK_LENGTH ((uint64_t) 1 << CHUNK_SHIFT) // values per chunk of a plot's storage
+#define MAX_CACHED_CHUNKS 8 // decompressed chunks per buffer
+#define MAX_COMPRESSED_CHUNKS_PER_FRAME 4
+#define IMPLICIT_X_TOLERANCE 1e-6 // appended x values this close to uniform spacing (relative to it) are stored as implicit x
+#define STREAM_RECEIVE_SIZE (1 << 20) // bytes read from a streaming connection at once
+#define MAX_STREAM_FRAME_SIZE ((uint64_t) 1 << 32) // larger frames are treated as a broken stream
+#define LOAD_CHUNK_SIZE ((uint64_t) 1 << 26) // bytes of a loaded file which are read before they are dropped from memory again
+#define MIN_CSV_CHUNK_SIZE ((uint64_t) 1 << 20) // smaller CSV files aren't split over more threads
+#define MIN_BOUNDS_CHUNK_LENGTH ((uint64_t) 1 << 24) // the values each thread bounds at least, so only large fills use threads
+#define PLOT_SHARD_COUNT 32
+
 extern const unsigned char gui_font_binary_ttf[];
 extern const unsigned int gui_font_binary_ttf_len;
 
 typedef uint32_t Plot_IDX;
 typedef uint32_t Group_IDX;
 
+static std::atomic<uint32_t> plot_handle_end { MAX_PLOT_SIZE }; // the next handle 'plot_create' hands out
+
 static bool valid_plot_idx(Plot_IDX plot_idx) {
-    if (plot_idx < MAX_PLOT_SIZE) {
+    if (plot_idx < plot_handle_end.load(std::memory_order_acquire)) {
         return true;
     }
-    printf(ERROR "The plot index '%u' is not within the valid fixed range of [0, %d]\n", plot_idx, PLOTLIB_MAX_PLOT_IDX);
+    printf(ERROR "The plot index '%u' is neither within the valid fixed range of [0, %d] nor a handle from 'plot_create'\n",
+           plot_idx, PLOTLIB_MAX_PLOT_IDX);
     return false;
 }
 
@@ -123,1324 +177,5394 @@ static rl::Color to_rl_color(Color color) {
     return rl::Color{ color.r, color.g, color.b, color.a };
 }
 
-struct Plot {
-    std::vector<double> points_x;
-    std::vector<double> points_y;
-
-    Color color;
-    bool show_lines = true;
-    double line_width = 1.0;
-    bool show_points = false;
-    double point_diameter = 3.0;
-    
-    bool initialized = false;
-    
-    char* label = nullptr;
-    
-    Range_XY bb = { MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE }; // bounding box
-    
-    bool has_x_coordinate() { return !points_x.empty() && points_x.size() == points_y.size(); }
-    bool empty() { return points_x.empty() && points_y.empty(); }
-};
-
-struct Plot_Update {
-    std::vector<double> new_points_x;
-    std::vector<double> new_points_y;
-
-    bool has_custom_color = false;
-    Color custom_color;
-    bool show_lines = true;
-    double line_width = 1.0;
-    bool show_points = false;
-    double point_diameter = 3.0;
-    char* new_name = nullptr;
-
-    bool empty_update = true; // true -> safe to skip the update
-    bool was_cleared = false;
+// Memory which the user lent to plotlib, the release callback is called once the last Sample_Buffer referencing it lets go.
+struct Borrowed_Memory {
+    plotlib_release_fn release = nullptr;
+    void* user_data = nullptr;
 
-    bool contains_points = false;
-    bool contains_numbers = false;
+    Borrowed_Memory(plotlib_release_fn release, void* user_data) : release(release), user_data(user_data) {}
+    Borrowed_Memory(const Borrowed_Memory&) = delete;
+    Borrowed_Memory& operator=(const Borrowed_Memory&) = delete;
 
-    bool accepts_numbers() { return contains_numbers || !contains_points; }
-    bool accepts_points() { return contains_points || !contains_numbers; }
-    
-    // Resets everything which was just a delta and not a mirror of the actual state.
-    void reset() {
-        new_points_x.clear();
-        new_points_y.clear();
-        has_custom_color = false;
-        
-        delete new_name;
-        new_name = nullptr;
-        
-        was_cleared = false;
-        empty_update = true;
+    ~Borrowed_Memory() {
+        if (release) release(user_data);
     }
+};
 
-    void clear_plot() {
-        new_points_x.clear();
-        new_points_y.clear();
-        contains_points = false;
-        contains_numbers = false;
-        was_cleared = true;
-        empty_update = false;
+static uint64_t sample_type_size(uint32_t sample_type)
+{
+    switch (sample_type) {
+    case PLOTLIB_SAMPLE_F64: return sizeof(double);
+    case PLOTLIB_SAMPLE_F32: return sizeof(float);
+    case PLOTLIB_SAMPLE_I32: return sizeof(int32_t);
+    case PLOTLIB_SAMPLE_I16: return sizeof(int16_t);
+    case PLOTLIB_SAMPLE_U16: return sizeof(uint16_t);
+    case PLOTLIB_SAMPLE_I64: return sizeof(int64_t);
+    default: return 0;
     }
-};
+}
 
-struct Plot_Group {
-    std::vector<Plot_IDX> plots;
-    char* label = nullptr;
-    bool initialized = false;
+// How the values of a Sample_Buffer are stored, the stored sample 's' is the value 's * scale + offset'. 64-bit integer
+// samples are the value '(s - origin) * scale + offset', the origin is subtracted before converting them to double.
+struct Sample_Encoding {
+    uint32_t sample_type = PLOTLIB_SAMPLE_F64;
+    double scale = 1.0;
+    double offset = 0.0;
+    int64_t origin = 0;
 };
 
-struct Plot_Group_Update {
-    std::vector<Plot_IDX> new_plots;
-    std::vector<Plot_IDX> remove_plots;
-    
-    char* new_name = nullptr;
-    
-    bool empty_update = true;
-    bool was_cleared = false;
-
-    void reset() {
-        new_plots.clear();
-        remove_plots.clear();
-
-        delete new_name;
-        new_name = nullptr;
-        
-        was_cleared = false;
-        empty_update = true;
+// The decode kernels convert two values per SSE2 instruction, the scalar loops handle the rest.
+static void decode_f64(const double* samples, double scale, double offset, uint64_t count, double* values)
+{
+    uint64_t i = 0;
+#ifdef HAS_SSE2
+    __m128d scale_2 = _mm_set1_pd(scale), offset_2 = _mm_set1_pd(offset);
+    for (; i + 2 <= count; i += 2) {
+        _mm_storeu_pd(values + i, _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(samples + i), scale_2), offset_2));
     }
+#endif
+    for (; i < count; ++i) values[i] = samples[i] * scale + offset;
+}
 
-    void clear_group() {
-        new_plots.clear();
-        remove_plots.clear();
-        was_cleared = true;
-        empty_update = false;
+static void decode_f32(const float* samples, double scale, double offset, uint64_t count, double* values)
+{
+    uint64_t i = 0;
+#ifdef HAS_SSE2
+    __m128d scale_2 = _mm_set1_pd(scale), offset_2 = _mm_set1_pd(offset);
+    for (; i + 4 <= count; i += 4) {
+        __m128 samples_4 = _mm_loadu_ps(samples + i);
+        _mm_storeu_pd(values + i, _mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(samples_4), scale_2), offset_2));
+        _mm_storeu_pd(values + i + 2, _mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(samples_4, samples_4)), scale_2), offset_2));
     }
-};
+#endif
+    for (; i < count; ++i) values[i] = samples[i] * scale + offset;
+}
 
-struct Theme_Colors {
-    rl::Color text;
-    rl::Color backgound;
-    rl::Color tick_lines;
-    rl::Color coordinate_axes;
-    rl::Color plot_screen_border;
-};
+#ifdef HAS_SSE2
+static inline void decode_i32x4(__m128i samples_4, __m128d scale_2, __m128d offset_2, double* values)
+{
+    _mm_storeu_pd(values, _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(samples_4), scale_2), offset_2));
+    _mm_storeu_pd(values + 2, _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(samples_4, 8)), scale_2), offset_2));
+}
+#endif
 
-static const Theme_Colors dark_theme_colors = {
-    .text               = { 0xff, 0xff, 0xff, 0xff},
-    .backgound          = { 0x25, 0x25, 0x25, 0xff },
-    .tick_lines         = { 0xff, 0xff, 0xff, 0x10 },
-    .coordinate_axes    = { 0xff, 0xff, 0xff, 0x40 },
-    .plot_screen_border = { 0xff, 0xff, 0xff, 0xff },
-};
+static void decode_i32(const int32_t* samples, double scale, double offset, uint64_t count, double* values)
+{
+    uint64_t i = 0;
+#ifdef HAS_SSE2
+    __m128d scale_2 = _mm_set1_pd(scale), offset_2 = _mm_set1_pd(offset);
+    for (; i + 4 <= count; i += 4) {
+        decode_i32x4(_mm_loadu_si128((const __m128i*) (samples + i)), scale_2, offset_2, values + i);
+    }
+#endif
+    for (; i < count; ++i) values[i] = samples[i] * scale + offset;
+}
 
-static const Theme_Colors light_theme_colors = {
-    .text               = { 0x00, 0x00, 0x00, 0xff},
-    .backgound          = { 0xfd, 0xfd, 0xfd, 0xff },
-    .tick_lines         = { 0x00, 0x00, 0x00, 0x10 },
-    .coordinate_axes    = { 0x00, 0x00, 0x00, 0x40 },
-    .plot_screen_border = { 0x00, 0x00, 0x00, 0xff },
-};
+static void decode_i16(const int16_t* samples, double scale, double offset, uint64_t count, double* values)
+{
+    uint64_t i = 0;
+#ifdef HAS_SSE2
+    __m128d scale_2 = _mm_set1_pd(scale), offset_2 = _mm_set1_pd(offset);
+    for (; i + 8 <= count; i += 8) {
+        __m128i samples_8 = _mm_loadu_si128((const __m128i*) (samples + i));
+        decode_i32x4(_mm_srai_epi32(_mm_unpacklo_epi16(samples_8, samples_8), 16), scale_2, offset_2, values + i); // sign extended
+        decode_i32x4(_mm_srai_epi32(_mm_unpackhi_epi16(samples_8, samples_8), 16), scale_2, offset_2, values + i + 4);
+    }
+#endif
+    for (; i < count; ++i) values[i] = samples[i] * scale + offset;
+}
 
-struct Gui {
-    int target_fps = DEFAULT_FPS;
-    
-    rl::Font font_normal;
-    rl::Font font_large;
-    float fontsize_normal = 22;
-    float fontsize_large = 24;
-    float fontspacing = 0;
+static void decode_u16(const uint16_t* samples, double scale, double offset, uint64_t count, double* values)
+{
+    uint64_t i = 0;
+#ifdef HAS_SSE2
+    __m128d scale_2 = _mm_set1_pd(scale), offset_2 = _mm_set1_pd(offset);
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i samples_8 = _mm_loadu_si128((const __m128i*) (samples + i));
+        decode_i32x4(_mm_unpacklo_epi16(samples_8, zero), scale_2, offset_2, values + i); // zero extended
+        decode_i32x4(_mm_unpackhi_epi16(samples_8, zero), scale_2, offset_2, values + i + 4);
+    }
+#endif
+    for (; i < count; ++i) values[i] = samples[i] * scale + offset;
+}
 
-    int window_width = DEFAULT_WINDOW_WIDTH;
-    int window_height = DEFAULT_WINDOW_HEIGHT;
+// 64-bit integers can't be converted with SSE2, and the subtraction of the origin has to be exact anyway.
+static void decode_i64(const int64_t* samples, int64_t origin, double scale, double offset, uint64_t count, double* values)
+{
+    for (uint64_t i = 0; i < count; ++i) {
+        values[i] = (double) (int64_t) ((uint64_t) samples[i] - (uint64_t) origin) * scale + offset;
+    }
+}
 
-    int x_pixels_per_tick = 50;
-    int y_pixels_per_tick = 50;
+// The bound kernels grow [min, max] by the values. NaNs are skipped, the min and max instructions return their second
+// operand if either is NaN, just like the comparisons of the scalar loops.
+static void bound_values_scalar(const double* values, uint64_t count, double& min, double& max)
+{
+    uint64_t i = 0;
+#ifdef HAS_SSE2
+    __m128d min_0 = _mm_set1_pd(min), min_1 = min_0, max_0 = _mm_set1_pd(max), max_1 = max_0;
+    for (; i + 4 <= count; i += 4) {
+        __m128d values_0 = _mm_loadu_pd(values + i), values_1 = _mm_loadu_pd(values + i + 2);
+        min_0 = _mm_min_pd(values_0, min_0);
+        min_1 = _mm_min_pd(values_1, min_1);
+        max_0 = _mm_max_pd(values_0, max_0);
+        max_1 = _mm_max_pd(values_1, max_1);
+    }
+    double mins[2], maxs[2];
+    _mm_storeu_pd(mins, _mm_min_pd(min_0, min_1));
+    _mm_storeu_pd(maxs, _mm_max_pd(max_0, max_1));
+    min = std::min(mins[0], mins[1]);
+    max = std::max(maxs[0], maxs[1]);
+#endif
+    for (; i < count; ++i) {
+        min = values[i] < min ? values[i] : min;
+        max = values[i] > max ? values[i] : max;
+    }
+}
 
-    int tick_mark_len = DEFAULT_TICK_MARK_LEN;
-    float plot_screen_border_width = 1;
+#ifdef HAS_AVX_DISPATCH
+__attribute__((target("avx")))
+static void bound_values_avx(const double* values, uint64_t count, double& min, double& max)
+{
+    uint64_t i = 0;
+    __m256d min_0 = _mm256_set1_pd(min), min_1 = min_0, max_0 = _mm256_set1_pd(max), max_1 = max_0;
+    for (; i + 8 <= count; i += 8) {
+        __m256d values_0 = _mm256_loadu_pd(values + i), values_1 = _mm256_loadu_pd(values + i + 4);
+        min_0 = _mm256_min_pd(values_0, min_0);
+        min_1 = _mm256_min_pd(values_1, min_1);
+        max_0 = _mm256_max_pd(values_0, max_0);
+        max_1 = _mm256_max_pd(values_1, max_1);
+    }
+    double mins[4], maxs[4];
+    _mm256_storeu_pd(mins, _mm256_min_pd(min_0, min_1));
+    _mm256_storeu_pd(maxs, _mm256_max_pd(max_0, max_1));
+    for (int lane = 0; lane < 4; ++lane) {
+        min = std::min(mins[lane], min);
+        max = std::max(maxs[lane], max);
+    }
+    bound_values_scalar(values + i, count - i, min, max);
+}
 
-    float offset_normal = 5;
-    float offset_small = 2;
+__attribute__((target("avx512f")))
+static void bound_values_avx512(const double* values, uint64_t count, double& min, double& max)
+{
+    uint64_t i = 0;
+    // The masked forms with all lanes set compile to the same instructions. GCC 12 implements the unmasked ones with an
+    // undefined pass-through vector, which -Wall reports as uninitialized.
+    const __mmask8 all_lanes = 0xFF;
+    __m512d min_0 = _mm512_set1_pd(min), min_1 = min_0, max_0 = _mm512_set1_pd(max), max_1 = max_0;
+    for (; i + 16 <= count; i += 16) {
+        __m512d values_0 = _mm512_loadu_pd(values + i), values_1 = _mm512_loadu_pd(values + i + 8);
+        min_0 = _mm512_mask_min_pd(min_0, all_lanes, values_0, min_0);
+        min_1 = _mm512_mask_min_pd(min_1, all_lanes, values_1, min_1);
+        max_0 = _mm512_mask_max_pd(max_0, all_lanes, values_0, max_0);
+        max_1 = _mm512_mask_max_pd(max_1, all_lanes, values_1, max_1);
+    }
+    double mins[8], maxs[8];
+    _mm512_storeu_pd(mins, _mm512_mask_min_pd(min_0, all_lanes, min_0, min_1));
+    _mm512_storeu_pd(maxs, _mm512_mask_max_pd(max_0, all_lanes, max_0, max_1));
+    for (int lane = 0; lane < 8; ++lane) {
+        min = std::min(mins[lane], min);
+        max = std::max(maxs[lane], max);
+    }
+    bound_values_scalar(values + i, count - i, min, max);
+}
+#endif
 
-    float zoom_to_zero_pixel_distance_threshold = DEFAULT_ZOOM_TO_ZERO_PIXEL_DISTANCE_THRESHOLD;
-    int zoom_resize_cooldown = 0;
+typedef void (*Bound_Values_Fn)(const double* values, uint64_t count, double& min, double& max);
 
-    Theme_Colors colors;
-};
+static Bound_Values_Fn select_bound_values()
+{
+#ifdef HAS_AVX_DISPATCH
+    __builtin_cpu_init(); // this runs before the constructors which would initialize the cpu features
+    if (__builtin_cpu_supports("avx512f")) return bound_values_avx512;
+    if (__builtin_cpu_supports("avx")) return bound_values_avx;
+#endif
+    return bound_values_scalar;
+}
 
-struct Visualization_Mode {
-    enum : uint32_t {
-        NONE,
-        INTERACTIVE,
-        SHOW_N_POINTS_OF_TAIL,
-        SHOW_X_RANGE_OF_TAIL,
-        SHOW_ENTIRE_PLOT_GROUP,
-        SHOW_SPECIFIC_PLOT,
-    };
-    uint32_t type = NONE;
-    uint64_t n_points = 0;
-    double x_range = 0;
-    Plot_IDX specific_plot = INVALID_IDX;
-};
+static const Bound_Values_Fn bound_values = select_bound_values();
 
-struct Plotlib_State {
-    Plot plots[MAX_PLOT_SIZE];
-    Plot_Group plot_groups[MAX_PLOT_GROUP_SIZE];
+// Converts 'count' dense samples into doubles.
+static void decode_samples(const uint8_t* samples, Sample_Encoding encoding, uint64_t count, double* values)
+{
+    switch (encoding.sample_type) {
+    case PLOTLIB_SAMPLE_F64: decode_f64((const double*) samples, encoding.scale, encoding.offset, count, values); break;
+    case PLOTLIB_SAMPLE_F32: decode_f32((const float*) samples, encoding.scale, encoding.offset, count, values); break;
+    case PLOTLIB_SAMPLE_I32: decode_i32((const int32_t*) samples, encoding.scale, encoding.offset, count, values); break;
+    case PLOTLIB_SAMPLE_I16: decode_i16((const int16_t*) samples, encoding.scale, encoding.offset, count, values); break;
+    case PLOTLIB_SAMPLE_U16: decode_u16((const uint16_t*) samples, encoding.scale, encoding.offset, count, values); break;
+    case PLOTLIB_SAMPLE_I64: decode_i64((const int64_t*) samples, encoding.origin, encoding.scale, encoding.offset, count, values); break;
+    default: assert(false);
+    }
+}
 
-    Group_IDX visible_group = DEFAULT_PLOT_GROUP_IDX;
-    Visualization_Mode vis_mode { .type=Visualization_Mode::SHOW_ENTIRE_PLOT_GROUP };
-    
-    Range_XY plot_range = Range_XY{};
-    rl::Rectangle plot_screen = rl::Rectangle{ 0, 0, DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT };
+// Gathers samples which are 'stride' bytes apart, e.g. a field of an array of structs. The samples don't have to be aligned.
+// Four independent loads per iteration, so they overlap instead of waiting on each other.
+template <typename T>
+static void gather_samples(const uint8_t* samples, uint64_t stride, uint64_t count, double* values)
+{
+    T sample[4];
+    uint64_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        memcpy(&sample[0], samples + i * stride, sizeof(T));
+        memcpy(&sample[1], samples + (i + 1) * stride, sizeof(T));
+        memcpy(&sample[2], samples + (i + 2) * stride, sizeof(T));
+        memcpy(&sample[3], samples + (i + 3) * stride, sizeof(T));
+        values[i] = (double) sample[0];
+        values[i + 1] = (double) sample[1];
+        values[i + 2] = (double) sample[2];
+        values[i + 3] = (double) sample[3];
+    }
+    for (; i < count; ++i) {
+        memcpy(&sample[0], samples + i * stride, sizeof(T));
+        values[i] = (double) sample[0];
+    }
+}
 
-    Gui gui;
-    bool window_is_init = false;
-    bool window_visible = false;
-    bool terminate = false;
-};
+// Converts 'count' samples, 'stride' bytes apart, into dense doubles.
+static void convert_samples_to_double(const uint8_t* samples, uint32_t sample_type, uint64_t stride, uint64_t count, double* values)
+{
+    if (stride == sample_type_size(sample_type)) {
+        decode_samples(samples, Sample_Encoding{ sample_type, 1.0, 0.0 }, count, values);
+        return;
+    }
+    switch (sample_type) {
+    case PLOTLIB_SAMPLE_F64: gather_samples<double>(samples, stride, count, values); break;
+    case PLOTLIB_SAMPLE_F32: gather_samples<float>(samples, stride, count, values); break;
+    case PLOTLIB_SAMPLE_I32: gather_samples<int32_t>(samples, stride, count, values); break;
+    case PLOTLIB_SAMPLE_I16: gather_samples<int16_t>(samples, stride, count, values); break;
+    case PLOTLIB_SAMPLE_U16: gather_samples<uint16_t>(samples, stride, count, values); break;
+    case PLOTLIB_SAMPLE_I64: gather_samples<int64_t>(samples, stride, count, values); break;
+    default: assert(false);
+    }
+}
 
-struct Plotlib_State_Update {
-    Plot_Update plot_updates[MAX_PLOT_SIZE];
-    Plot_Group_Update plot_group_updates[MAX_PLOT_GROUP_SIZE];
-    
-    Group_IDX visible_group = DEFAULT_PLOT_GROUP_IDX;
-    Visualization_Mode vis_mode { .type=Visualization_Mode::SHOW_ENTIRE_PLOT_GROUP };
+// Integer samples are rounded and clamped to their range, NaN is stored as 0.
+template <typename T>
+static void encode_integers(const double* values, uint64_t stride, uint64_t count, double scale, double offset, T* samples)
+{
+    const double min_sample = std::numeric_limits<T>::min();
+    const double max_sample = std::numeric_limits<T>::max();
+    for (uint64_t i = 0; i < count; ++i) {
+        double sample = std::round((values[i * stride] - offset) / scale);
+        samples[i] = sample >= min_sample ? (sample <= max_sample ? (T) sample : (T) max_sample) : (sample < min_sample ? (T) min_sample : 0);
+    }
+}
 
-    Theme_Colors theme_colors = dark_theme_colors;
+static void encode_i64(const double* values, uint64_t stride, uint64_t count, Sample_Encoding encoding, int64_t* samples)
+{
+    const double max_sample = 9.2e18; // a bit less than INT64_MAX, which isn't representable as a double
+    for (uint64_t i = 0; i < count; ++i) {
+        double sample = std::round((values[i * stride] - encoding.offset) / encoding.scale);
+        int64_t delta = sample >= -max_sample ? (sample <= max_sample ? (int64_t) sample : (int64_t) max_sample)
+                                              : (sample < -max_sample ? (int64_t) -max_sample : 0);
+        samples[i] = (int64_t) ((uint64_t) encoding.origin + (uint64_t) delta);
+    }
+}
 
-    bool window_visible = false;
-    bool terminate = false;
+// Converts 'count' doubles, 'stride' apart, into dense samples.
+static void encode_samples(const double* values, uint64_t stride, uint64_t count, Sample_Encoding encoding, uint8_t* samples)
+{
+    switch (encoding.sample_type) {
+    case PLOTLIB_SAMPLE_F64:
+        if (stride == 1) {
+            if (count > 0) memcpy(samples, values, count * sizeof(double));
+        }
+        else {
+            for (uint64_t i = 0; i < count; ++i) ((double*) samples)[i] = values[i * stride];
+        }
+        break;
+    case PLOTLIB_SAMPLE_F32:
+        for (uint64_t i = 0; i < count; ++i) ((float*) samples)[i] = (float) ((values[i * stride] - encoding.offset) / encoding.scale);
+        break;
+    case PLOTLIB_SAMPLE_I32: encode_integers(values, stride, count, encoding.scale, encoding.offset, (int32_t*) samples); break;
+    case PLOTLIB_SAMPLE_I16: encode_integers(values, stride, count, encoding.scale, encoding.offset, (int16_t*) samples); break;
+    case PLOTLIB_SAMPLE_U16: encode_integers(values, stride, count, encoding.scale, encoding.offset, (uint16_t*) samples); break;
+    case PLOTLIB_SAMPLE_I64: encode_i64(values, stride, count, encoding, (int64_t*) samples); break;
+    default: assert(false);
+    }
+}
 
-    void reset() {
-        for (Plot_IDX plot_idx = 0; plot_idx < MAX_PLOT_SIZE; ++plot_idx) {
-            if (!plot_updates[plot_idx].empty_update) {
-                plot_updates[plot_idx].reset();
-            }
+// Writes bits into zeroed words, the first bit is the most significant bit of the first word.
+struct Bit_Writer {
+    uint64_t* words;
+    uint64_t bit_count = 0;
+
+    // Writes the lowest 'count' bits of 'bits', 'count' is 1 to 64.
+    void write(uint64_t bits, uint32_t count) {
+        if (count < 64) bits &= ((uint64_t) 1 << count) - 1;
+        uint64_t word = bit_count >> 6;
+        uint32_t offset = bit_count & 63;
+        if (offset + count <= 64) {
+            words[word] |= bits << (64 - offset - count);
         }
-        for (Group_IDX group_idx = 0; group_idx < MAX_PLOT_GROUP_SIZE; ++group_idx) {
-            if (!plot_group_updates[group_idx].empty_update) {
-                plot_group_updates[group_idx].reset();
-            }
+        else {
+            words[word] |= bits >> (offset + count - 64);
+            words[word + 1] |= bits << (128 - offset - count);
         }
-        terminate = false;
+        bit_count += count;
     }
 };
 
-static Plotlib_State gps;
-static Plotlib_State_Update gps_update;
-static std::mutex gps_update_mutex;
+struct Bit_Reader {
+    const uint64_t* words;
+    uint64_t bit_count = 0;
+
+    uint64_t read(uint32_t count) {
+        uint64_t word = bit_count >> 6;
+        uint32_t offset = bit_count & 63;
+        uint64_t bits = words[word] << offset;
+        if (offset + count > 64) bits |= words[word + 1] >> (64 - offset);
+        bit_count += count;
+        return bits >> (64 - count);
+    }
+};
 
-static Range_XY bounding_box_of_plot(Plot& plot, uint64_t begin_idx)
+#define MAX_COMPRESSED_BITS_PER_SAMPLE 77 // a double whose xor has new leading and trailing zeros: 2 + 5 + 6 + 64 bits
+#define MAX_COMPRESSED_WORDS (CHUNK_LENGTH * MAX_COMPRESSED_BITS_PER_SAMPLE / 64 + 2) // one word of padding for the reader
+
+// Gorilla compression of doubles: every value is xor-ed with the previous one, the xor of slowly changing values has many
+// leading and trailing zeros which are not stored. '0' -> the same value, '10' -> the meaningful bits are within those
+// of the previous xor, '11' -> 5 bits leading zeros, 6 bits meaningful bit count - 1, then the meaningful bits.
+static void compress_f64(const uint64_t* samples, uint64_t count, Bit_Writer& writer)
 {
-    Range_XY bb = { MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE };
-    if (plot.has_x_coordinate()) {
-        for (uint64_t i = begin_idx; i < plot.points_y.size(); ++i) {
-            bb.x_begin = plot.points_x[i] < bb.x_begin ? plot.points_x[i] : bb.x_begin;
-            bb.x_end = plot.points_x[i] > bb.x_end ? plot.points_x[i] : bb.x_end;
-            bb.y_begin = plot.points_y[i] < bb.y_begin ? plot.points_y[i] : bb.y_begin;
-            bb.y_end = plot.points_y[i] > bb.y_end ? plot.points_y[i] : bb.y_end;
+    uint64_t previous = samples[0];
+    writer.write(previous, 64);
+    uint32_t previous_leading = 65; // no previous xor
+    uint32_t previous_trailing = 0;
+    for (uint64_t i = 1; i < count; ++i) {
+        uint64_t xored = samples[i] ^ previous;
+        previous = samples[i];
+        if (xored == 0) {
+            writer.write(0, 1);
+            continue;
+        }
+        uint32_t leading = std::min(__builtin_clzll(xored), 31);
+        uint32_t trailing = __builtin_ctzll(xored);
+        if (leading >= previous_leading && trailing >= previous_trailing) {
+            writer.write(0b10, 2);
+            writer.write(xored >> previous_trailing, 64 - previous_leading - previous_trailing);
+        }
+        else {
+            uint32_t meaningful = 64 - leading - trailing;
+            writer.write(0b11, 2);
+            writer.write(leading, 5);
+            writer.write(meaningful - 1, 6);
+            writer.write(xored >> trailing, meaningful);
+            previous_leading = leading;
+            previous_trailing = trailing;
         }
     }
-    else {
-        bb.x_begin = begin_idx;
-        bb.x_end = plot.points_y.size() - 1;
-        for (uint64_t i = begin_idx; i < plot.points_y.size(); ++i) {
-            bb.y_begin = plot.points_y[i] < bb.y_begin ? plot.points_y[i] : bb.y_begin;
-            bb.y_end = plot.points_y[i] > bb.y_end ? plot.points_y[i] : bb.y_end;
+}
+
+static void decompress_f64(Bit_Reader& reader, uint64_t count, uint64_t* samples)
+{
+    uint64_t previous = samples[0] = reader.read(64);
+    uint32_t previous_leading = 0;
+    uint32_t previous_trailing = 0;
+    for (uint64_t i = 1; i < count; ++i) {
+        if (reader.read(1) == 1) {
+            if (reader.read(1) == 1) {
+                previous_leading = reader.read(5);
+                previous_trailing = 64 - previous_leading - (reader.read(6) + 1);
+            }
+            previous ^= reader.read(64 - previous_leading - previous_trailing) << previous_trailing;
         }
+        samples[i] = previous;
     }
-    return bb;
 }
 
-static Range_XY bounding_box_of_plots_bounding_boxes(std::vector<Plot_IDX>& plots)
+// Delta-of-delta compression of integers like timestamps: the difference to the previous difference is zigzag encoded and
+// stored in '0' -> 0 bits, '10' -> 7 bits, '110' -> 12 bits, '1110' -> 20 bits, '11110' -> 32 bits, '11111' -> 64 bits.
+// The larger sizes than Gorilla's are for nanosecond timestamps, whose jitter is thousands of nanoseconds.
+static void compress_i64(const uint64_t* samples, uint64_t count, Bit_Writer& writer)
 {
-    Range_XY bb = { MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE };
-    for (uint64_t i = 0; i < plots.size(); ++i) {
-        Plot plot = gps.plots[plots[i]];
-        bb.x_begin = plot.bb.x_begin < bb.x_begin ? plot.bb.x_begin : bb.x_begin;
-        bb.x_end = plot.bb.x_end > bb.x_end ? plot.bb.x_end : bb.x_end;
-        bb.y_begin = plot.bb.y_begin < bb.y_begin ? plot.bb.y_begin : bb.y_begin;
-        bb.y_end = plot.bb.y_end > bb.y_end ? plot.bb.y_end : bb.y_end;
+    writer.write(samples[0], 64);
+    uint64_t previous_delta = 0;
+    for (uint64_t i = 1; i < count; ++i) {
+        uint64_t delta = samples[i] - samples[i - 1];
+        int64_t delta_of_delta = (int64_t) (delta - previous_delta);
+        uint64_t zigzag = ((uint64_t) delta_of_delta << 1) ^ (uint64_t) (delta_of_delta >> 63);
+        previous_delta = delta;
+        if (zigzag == 0) {
+            writer.write(0, 1);
+        }
+        else if (zigzag < (1 << 7)) {
+            writer.write(0b10, 2);
+            writer.write(zigzag, 7);
+        }
+        else if (zigzag < (1 << 12)) {
+            writer.write(0b110, 3);
+            writer.write(zigzag, 12);
+        }
+        else if (zigzag < (1 << 20)) {
+            writer.write(0b1110, 4);
+            writer.write(zigzag, 20);
+        }
+        else if (zigzag < ((uint64_t) 1 << 32)) {
+            writer.write(0b11110, 5);
+            writer.write(zigzag, 32);
+        }
+        else {
+            writer.write(0b11111, 5);
+            writer.write(zigzag, 64);
+        }
     }
-    return bb;
 }
 
-static Range_XY bounding_box_of_bounding_boxes(std::vector<Range_XY>& bbs)
+static void decompress_i64(Bit_Reader& reader, uint64_t count, uint64_t* samples)
 {
-    Range_XY bb = { MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE };
-    for (uint64_t i = 0; i < bbs.size(); ++i) {
-        bb.x_begin = bbs[i].x_begin < bb.x_begin ? bbs[i].x_begin : bb.x_begin;
-        bb.x_end = bbs[i].x_end > bb.x_end ? bbs[i].x_end : bb.x_end;
-        bb.y_begin = bbs[i].y_begin < bb.y_begin ? bbs[i].y_begin : bb.y_begin;
-        bb.y_end = bbs[i].y_end > bb.y_end ? bbs[i].y_end : bb.y_end;
+    samples[0] = reader.read(64);
+    uint64_t delta = 0;
+    for (uint64_t i = 1; i < count; ++i) {
+        uint32_t prefix = 0;
+        while (prefix < 5 && reader.read(1) == 1) ++prefix;
+        static const uint32_t bit_counts[6] = { 0, 7, 12, 20, 32, 64 };
+        if (prefix > 0) {
+            uint64_t zigzag = reader.read(bit_counts[prefix]);
+            delta += (zigzag >> 1) ^ (0 - (zigzag & 1));
+        }
+        samples[i] = samples[i - 1] + delta;
     }
-    return bb;
 }
 
-static void apply_and_reset_gps_update()
+// Compresses a chunk of 64-bit samples into 'words', returns the compressed size in bytes.
+static uint64_t compress_chunk(const uint8_t* samples, uint32_t sample_type, uint64_t* words)
 {
-    gps_update_mutex.lock();
-    
-    gps.visible_group = gps_update.visible_group;
-    gps.window_visible = gps_update.window_visible;
-    gps.vis_mode = gps_update.vis_mode;
-    gps.terminate = gps_update.terminate;
+    memset(words, 0, MAX_COMPRESSED_WORDS * sizeof(uint64_t));
+    Bit_Writer writer { words };
+    if (sample_type == PLOTLIB_SAMPLE_F64) compress_f64((const uint64_t*) samples, CHUNK_LENGTH, writer);
+    else compress_i64((const uint64_t*) samples, CHUNK_LENGTH, writer);
+    return ((writer.bit_count + 63) / 64 + 1) * sizeof(uint64_t);
+}
 
-    if (!gps.window_visible) {
-        gps_update_mutex.unlock();
-        return;
-    }
-    
-    gps.gui.colors = gps_update.theme_colors;
+static void decompress_chunk(const uint8_t* compressed, uint32_t sample_type, uint8_t* samples)
+{
+    Bit_Reader reader { (const uint64_t*) compressed };
+    if (sample_type == PLOTLIB_SAMPLE_F64) decompress_f64(reader, CHUNK_LENGTH, (uint64_t*) samples);
+    else decompress_i64(reader, CHUNK_LENGTH, (uint64_t*) samples);
+}
 
-    for (Plot_IDX plot_idx = 0; plot_idx < MAX_PLOT_SIZE; ++plot_idx)
-    {
-        Plot_Update& update = gps_update.plot_updates[plot_idx];
-        if (update.empty_update) continue;
+// A growable array of values, like std::vector, which can also reference borrowed memory instead of owning its values.
+// Borrowed values are read-only, anything which changes the length first copies them into owned memory, except for
+// 'erase_front' which only moves the start of the values forward.
+// A buffer which grows in chunks moves at most CHUNK_LENGTH values when it grows, the values which don't fit into its
+// contiguous memory are stored in chunks of CHUNK_LENGTH values. Its borrowed values then also aren't copied when appending,
+// unless there are less than CHUNK_LENGTH of them. The oldest chunks can be spilled to a file, they are then mapped from it
+// and only read in by the OS when they are accessed. Chunks which are no longer appended to can also be compressed, they
+// are then decompressed into a small cache when they are read.
+// The values are doubles unless the buffer is encoded, then they can only be accessed through 'read' and 'write'.
+struct Sample_Chunk {
+    uint8_t* values = nullptr; // null while the chunk is compressed and not in the cache
+    uint8_t* compressed = nullptr; // null if the chunk isn't compressed
+    uint64_t compressed_size = 0;
+    bool incompressible = false; // compressing it didn't save enough
+};
 
-        Plot& plot = gps.plots[plot_idx];
+struct Sample_Buffer {
+    uint8_t* values = nullptr; // the first 'contiguous_length' values
+    uint64_t contiguous_length = 0;
+    uint64_t length = 0;
+    uint8_t* allocation = nullptr; // owned memory which 'values' points into, null if the values are borrowed
+    uint64_t allocation_length = 0;
+    std::shared_ptr<Borrowed_Memory> borrowed;
+
+    bool grows_in_chunks = false;
+    mutable std::vector<Sample_Chunk> chunks; // the values after the contiguous ones, reading them can fill the cache
+    uint64_t chunk_head = 0; // where in the first chunk the values begin
+
+    uint64_t compressed_count = 0;
+    uint64_t compressed_size = 0;
+    mutable uint64_t cached_count = 0; // compressed chunks whose values are decompressed
+
+    // The first 'spilled_count' chunks are mapped from the 'spill_file', which is deleted as soon as it is created.
+    // The file holds 'spill_file_length' chunks, the spilled chunks are the last ones of them.
+    int spill_file = -1;
+    uint64_t spilled_count = 0;
+    uint64_t spill_file_length = 0;
+
+    Sample_Encoding encoding;
+    uint64_t sample_size = sizeof(double);
+
+    Sample_Buffer() = default;
+    explicit Sample_Buffer(bool grows_in_chunks) : grows_in_chunks(grows_in_chunks) {}
+    Sample_Buffer(const Sample_Buffer&) = delete;
+    Sample_Buffer& operator=(const Sample_Buffer&) = delete;
+
+    ~Sample_Buffer() {
+        free(allocation);
+        free_chunks(0);
+    }
 
-        if (!plot.initialized) {
-            int label_len = 12; // should be enough for "[plot_idx]"
-            plot.label = new char[label_len];
-            snprintf(plot.label, label_len, "[%d]", plot_idx);
-            plot.label[label_len - 1] = '\0';
-            
-            plot.color = plot_color_table[plot_idx % plot_color_table_size];
-            
-            plot.initialized = true;
+    uint64_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    bool is_borrowed() const { return borrowed != nullptr; }
+    bool is_encoded() const { return encoding.sample_type != PLOTLIB_SAMPLE_F64; }
+    uint64_t capacity() const { return allocation ? allocation_length - (values - allocation) / sample_size : contiguous_length; }
+    uint64_t chunk_size() const { return CHUNK_LENGTH * sample_size; }
+    uint64_t memory_size() const {
+        return allocation_length * sample_size + (chunks.size() - compressed_count + cached_count) * chunk_size() + compressed_size;
+    }
+    uint64_t resident_size() const { return memory_size() - spilled_count * chunk_size(); }
+    uint64_t live_size() const { return length * sample_size; }
+    bool mostly_unused() const { return allocation_length > 0 && 2 * contiguous_length <= allocation_length; } // then shrinking is worth the copy
+    // Spilled chunks are a prefix of the chunks, compressed chunks aren't spilled and the last chunk stays in memory.
+    bool can_spill() const { return chunks.size() > spilled_count + 1 && !chunks[spilled_count].compressed; }
+    bool can_compress() const { return sample_size == 8 && (encoding.sample_type == PLOTLIB_SAMPLE_F64 || encoding.sample_type == PLOTLIB_SAMPLE_I64); }
+    double& operator[](uint64_t i) { assert(!is_encoded()); return *(double*) locate_for_write(i, nullptr); }
+    const double& operator[](uint64_t i) const { assert(!is_encoded()); return *(const double*) locate(i, nullptr); }
+
+    // Returns where the value 'i' is stored and, in 'run_length', how many values are stored contiguously from there.
+    // The values of a compressed chunk stay valid until other compressed chunks of this buffer are read.
+    const uint8_t* locate(uint64_t i, uint64_t* run_length) const {
+        if (i < contiguous_length) {
+            if (run_length) *run_length = contiguous_length - i;
+            return values + i * sample_size;
         }
+        uint64_t position = chunk_head + i - contiguous_length;
+        uint64_t in_chunk = position & (CHUNK_LENGTH - 1);
+        if (run_length) *run_length = CHUNK_LENGTH - in_chunk;
+        return chunk_values(position >> CHUNK_SHIFT) + in_chunk * sample_size;
+    }
 
-        if (update.has_custom_color) {
-            plot.color = update.custom_color;
-        }
+    // Like 'locate', but a compressed chunk is decompressed for good, so the values can be changed.
+    uint8_t* locate_for_write(uint64_t i, uint64_t* run_length) {
+        if (i >= contiguous_length) decompress((chunk_head + i - contiguous_length) >> CHUNK_SHIFT);
+        return const_cast<uint8_t*>(locate(i, run_length));
+    }
 
-        plot.show_lines = update.show_lines;
-        plot.line_width = update.line_width;
-        plot.show_points = update.show_points;
-        plot.point_diameter = update.point_diameter;
+    void decompress(uint64_t chunk_idx) {
+        Sample_Chunk& chunk = chunks[chunk_idx];
+        if (!chunk.compressed) return;
+        chunk_values(chunk_idx);
+        free(chunk.compressed);
+        compressed_size -= chunk.compressed_size;
+        chunk.compressed = nullptr;
+        chunk.compressed_size = 0;
+        --compressed_count;
+        --cached_count;
+    }
 
-        if (update.new_name) {
-            int label_len = 12 + strlen(update.new_name) + 1;
-            delete plot.label;
-            plot.label = new char[label_len];
-            snprintf(plot.label, label_len, "[%d] %s", plot_idx, update.new_name);
-            plot.label[label_len - 1] = '\0';
+    uint8_t* chunk_values(uint64_t chunk_idx) const {
+        Sample_Chunk& chunk = chunks[chunk_idx];
+        if (!chunk.values) {
+            if (cached_count >= MAX_CACHED_CHUNKS) drop_cache();
+            chunk.values = (uint8_t*) malloc(chunk_size());
+            decompress_chunk(chunk.compressed, encoding.sample_type, chunk.values);
+            ++cached_count;
         }
+        return chunk.values;
+    }
 
-        uint64_t old_length = plot.points_y.size();
-        uint64_t new_length = old_length;
-        if (update.was_cleared || old_length == 0) {
-            new_length = 0;
-            plot.bb.x_begin = MAX_PLOTRANGE_VALUE;
-            plot.bb.x_end = -MAX_PLOTRANGE_VALUE;
-            plot.bb.y_begin = MAX_PLOTRANGE_VALUE;
-            plot.bb.y_end = -MAX_PLOTRANGE_VALUE;
-        }
-        new_length += update.new_points_y.size();
-        uint64_t points_update_offset = new_length - update.new_points_y.size();
-        
-        if (update.contains_points) {
-            assert(update.new_points_x.size() == update.new_points_y.size());
-            plot.points_x.resize(new_length);
-            plot.points_y.resize(new_length);
-
-            for (uint64_t i = 0; i < update.new_points_y.size(); ++i) {
-                plot.points_x[i + points_update_offset] = update.new_points_x[i];
-                plot.points_y[i + points_update_offset] = update.new_points_y[i];
-
-                plot.bb.x_begin = update.new_points_x[i] < plot.bb.x_begin ? update.new_points_x[i] : plot.bb.x_begin;
-                plot.bb.x_end = update.new_points_x[i] > plot.bb.x_end ? update.new_points_x[i] : plot.bb.x_end;
-                plot.bb.y_begin = update.new_points_y[i] < plot.bb.y_begin ? update.new_points_y[i] : plot.bb.y_begin;
-                plot.bb.y_end = update.new_points_y[i] > plot.bb.y_end ? update.new_points_y[i] : plot.bb.y_end;
+    // Frees the decompressed values of all compressed chunks.
+    void drop_cache() const {
+        for (Sample_Chunk& chunk : chunks) {
+            if (chunk.compressed && chunk.values) {
+                free(chunk.values);
+                chunk.values = nullptr;
             }
         }
-        else {
-            assert(update.new_points_x.size() == 0);
-            plot.points_y.resize(new_length);
+        cached_count = 0;
+    }
 
-            plot.bb.x_begin = 0;
-            plot.bb.x_end = plot.points_y.size() == 0 ? 0 : plot.points_y.size() - 1;
-            for (uint64_t i = 0; i < update.new_points_y.size(); ++i) {
-                plot.points_y[i + points_update_offset] = update.new_points_y[i];
+    // Compresses the chunk if it saves at least a quarter of its memory, 'words' holds MAX_COMPRESSED_WORDS.
+    void compress(uint64_t chunk_idx, uint64_t* words) {
+        Sample_Chunk& chunk = chunks[chunk_idx];
+        assert(can_compress() && chunk_idx >= spilled_count && !chunk.compressed);
+        uint64_t size = compress_chunk(chunk.values, encoding.sample_type, words);
+        if (size > chunk_size() / 4 * 3) {
+            chunk.incompressible = true;
+            return;
+        }
+        chunk.compressed = (uint8_t*) malloc(size);
+        memcpy(chunk.compressed, words, size);
+        chunk.compressed_size = size;
+        free(chunk.values);
+        chunk.values = nullptr;
+        compressed_size += size;
+        ++compressed_count;
+    }
 
-                plot.bb.y_begin = update.new_points_y[i] < plot.bb.y_begin ? update.new_points_y[i] : plot.bb.y_begin;
-                plot.bb.y_end = update.new_points_y[i] > plot.bb.y_end ? update.new_points_y[i] : plot.bb.y_end;
+    // Returns the values [begin, begin + count) as doubles, they are decoded or gathered into 'scratch' if the buffer is
+    // encoded or they aren't contiguous.
+    const double* read(uint64_t begin, uint64_t count, double* scratch) const {
+        if (count == 0) return scratch;
+        uint64_t run_length;
+        const uint8_t* run = locate(begin, &run_length);
+        if (!is_encoded() && run_length >= count) return (const double*) run;
+        if (!is_encoded()) {
+            for (uint64_t done = 0; done < count; done += run_length) {
+                if (done > 0) run = locate(begin + done, &run_length);
+                run_length = std::min(run_length, count - done);
+                memcpy(scratch + done, run, run_length * sizeof(double));
             }
+            return scratch;
+        }
+        for (uint64_t done = 0; done < count; done += run_length) {
+            if (done > 0) run = locate(begin + done, &run_length);
+            run_length = std::min(run_length, count - done);
+            decode_samples(run, encoding, run_length, scratch + done);
         }
+        return scratch;
     }
 
-    for (Group_IDX group_idx = 0; group_idx < MAX_PLOT_GROUP_SIZE; ++group_idx)
-    {
-        Plot_Group_Update& update = gps_update.plot_group_updates[group_idx];
-        if (update.empty_update) continue;
-        
-        Plot_Group& group = gps.plot_groups[group_idx];
-
-        if (!group.initialized) {
-            int label_len = 24; // should be enough for "[group_idx]"
-            group.label = new char[label_len];
-            snprintf(group.label, label_len, "[%d] Plot Group", group_idx);
-            group.label[label_len - 1] = '\0';
-            
-            group.initialized = true;
+    // Overwrites the values [begin, begin + count) with 'new_values', which are 'stride' apart.
+    void write(uint64_t begin, const double* new_values, uint64_t stride, uint64_t count) {
+        assert((!borrowed || begin >= contiguous_length) && begin + count <= length);
+        uint64_t run_length;
+        for (uint64_t done = 0; done < count; done += run_length) {
+            uint8_t* run = locate_for_write(begin + done, &run_length);
+            run_length = std::min(run_length, count - done);
+            encode_samples(new_values + done * stride, stride, run_length, encoding, run);
         }
+    }
 
-        if (update.new_name) {
-            int label_len = 12 + strlen(update.new_name) + 1;
-            delete group.label;
-            group.label = new char[label_len];
-            snprintf(group.label, label_len, "[%d] %s", group_idx, update.new_name);
-            group.label[label_len - 1] = '\0';
-        }
+    void swap(Sample_Buffer& other) {
+        std::swap(values, other.values);
+        std::swap(contiguous_length, other.contiguous_length);
+        std::swap(length, other.length);
+        std::swap(allocation, other.allocation);
+        std::swap(allocation_length, other.allocation_length);
+        borrowed.swap(other.borrowed);
+        chunks.swap(other.chunks);
+        std::swap(chunk_head, other.chunk_head);
+        std::swap(compressed_count, other.compressed_count);
+        std::swap(compressed_size, other.compressed_size);
+        std::swap(cached_count, other.cached_count);
+        std::swap(spill_file, other.spill_file);
+        std::swap(spilled_count, other.spilled_count);
+        std::swap(spill_file_length, other.spill_file_length);
+        std::swap(encoding, other.encoding);
+        std::swap(sample_size, other.sample_size);
+    }
 
-        if (update.was_cleared) {
-            group.plots.clear();
+    void reserve(uint64_t min_capacity) {
+        assert(chunks.empty());
+        if (borrowed) {
+            uint64_t new_allocation_length = std::max(min_capacity, length);
+            uint8_t* owned_values = (uint8_t*) malloc(new_allocation_length * sample_size);
+            if (length > 0) memcpy(owned_values, values, length * sample_size);
+            values = allocation = owned_values;
+            allocation_length = new_allocation_length;
+            borrowed.reset();
         }
-
-        for (size_t i = 0; i < update.new_plots.size(); ++i) {
-            bool already_contained = false;
-            for (size_t j = 0; j < group.plots.size(); ++j) {
-                already_contained |= group.plots[j] == update.new_plots[i];
+        else if (min_capacity > capacity()) {
+            bool compacting = values != allocation;
+            if (compacting) {
+                memmove(allocation, values, length * sample_size);
+                values = allocation;
             }
-            if (!already_contained) {
-                group.plots.push_back(update.new_plots[i]);
+            // After compacting there is room for as many values again, so values which are erased from the front and appended
+            // at the back are only moved once per 'length' appended values.
+            if (min_capacity > allocation_length || (compacting && allocation_length < 2 * length)) {
+                allocation_length = compacting ? std::max(min_capacity, 2 * length) : std::max(min_capacity, 2 * allocation_length);
+                values = allocation = (uint8_t*) realloc(allocation, allocation_length * sample_size);
             }
         }
+    }
 
-        for (size_t i = 0; i < update.remove_plots.size(); ++i) {
-            for (size_t j = 0; j < group.plots.size(); ++j) {
-                if (group.plots[j] == update.remove_plots[i]) {
-                    group.plots.erase(group.plots.begin() + j);
-                }
+    void resize(uint64_t new_length) {
+        // Buffers which grow in chunks also stay contiguous up to the length of a chunk, so small plots stay small.
+        bool contiguous = chunks.empty() && (!grows_in_chunks || new_length <= std::max(borrowed ? 0 : capacity(), CHUNK_LENGTH));
+        if (contiguous) {
+            if (borrowed || new_length > capacity()) {
+                reserve(new_length);
             }
+            contiguous_length = length = new_length;
+            return;
+        }
+        if (chunks.empty() && !borrowed) {
+            contiguous_length = std::min(new_length, capacity()); // the owned memory is filled up first
+        }
+        else {
+            contiguous_length = std::min(new_length, contiguous_length);
         }
+        uint64_t chunked_length = new_length - contiguous_length;
+        uint64_t chunk_count = chunked_length == 0 ? 0 : (chunk_head + chunked_length + CHUNK_LENGTH - 1) >> CHUNK_SHIFT;
+        free_chunks(chunk_count);
+        while (chunks.size() < chunk_count) {
+            chunks.push_back(Sample_Chunk{ (uint8_t*) malloc(chunk_size()) });
+        }
+        if (chunks.empty()) chunk_head = 0;
+        length = new_length;
     }
 
-    gps_update.reset();
-    
-    gps_update_mutex.unlock();
-}
+    void free_chunk(uint64_t chunk_idx) {
+        Sample_Chunk& chunk = chunks[chunk_idx];
+        if (chunk_idx < spilled_count) {
+            unmap_chunk(chunk.values);
+            return;
+        }
+        if (chunk.compressed) {
+            if (chunk.values) --cached_count;
+            free(chunk.compressed);
+            compressed_size -= chunk.compressed_size;
+            --compressed_count;
+        }
+        free(chunk.values);
+    }
 
-static double linear_map(double x, double in_min, double in_max, double out_min, double out_max) {
-    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
-}
+    // Frees the chunks after the first 'kept_count' ones.
+    void free_chunks(uint64_t kept_count) {
+        for (uint64_t i = kept_count; i < chunks.size(); ++i) free_chunk(i);
+        if (kept_count < chunks.size()) chunks.resize(kept_count);
+        if (kept_count < spilled_count) {
+            spill_file_length -= spilled_count - kept_count; // they were the last chunks of the file
+            spilled_count = kept_count;
+#ifndef _WIN32
+            if (ftruncate(spill_file, spill_file_length * chunk_size()) != 0) {} // only gives the disk space back
+#endif
+        }
+        if (chunks.empty()) close_spill_file();
+    }
 
-static void gui_update_plot_range_interactive_mode(Range_XY& plot_range, rl::Rectangle plot_screen)
-{
-    auto x_to_plotspace = [=](double x) -> double {
-        return linear_map(x, (double) plot_screen.x, (double) plot_screen.x + plot_screen.width, plot_range.x_begin, plot_range.x_end);
-    };
+    // Frees the first 'count' chunks, their values were all erased.
+    void free_front_chunks(uint64_t count) {
+        for (uint64_t i = 0; i < count; ++i) {
+            free_chunk(i);
+#if !defined(_WIN32) && defined(FALLOC_FL_PUNCH_HOLE)
+            if (i < spilled_count) {
+                uint64_t file_chunk = spill_file_length - spilled_count + i;
+                fallocate(spill_file, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, file_chunk * chunk_size(), chunk_size());
+            }
+#endif
+        }
+        chunks.erase(chunks.begin(), chunks.begin() + count);
+        spilled_count -= std::min(spilled_count, count);
+        if (chunks.empty()) close_spill_file();
+    }
 
-    auto y_to_plotspace = [=](double y) -> double {
-        return linear_map(y, (double) plot_screen.y, (double) plot_screen.y + plot_screen.height, plot_range.y_end, plot_range.y_begin);
-    };
+    void unmap_chunk(uint8_t* chunk) {
+#ifndef _WIN32
+        munmap(chunk, chunk_size());
+#else
+        (void) chunk;
+#endif
+    }
 
-    double plot_space_pan_x = 0;
-    double plot_space_pan_y = 0;
-    if (rl::IsMouseButtonDown(rl::MOUSE_LEFT_BUTTON)) {
-        rl::Vector2 mouse_delta = rl::GetMouseDelta();
-        plot_space_pan_x = x_to_plotspace(0) - x_to_plotspace(mouse_delta.x);
-        plot_space_pan_y = y_to_plotspace(0) - y_to_plotspace(mouse_delta.y);
+    void close_spill_file() {
+#ifndef _WIN32
+        if (spill_file >= 0) close(spill_file);
+#endif
+        spill_file = -1;
+        spilled_count = spill_file_length = 0;
     }
 
-    float mouse_wheel_delta = rl::GetMouseWheelMove();
-    double zoom_factor_x = std::pow(1.2, (double) -mouse_wheel_delta * SCROLL_ZOOM_FACTOR);
-    double zoom_factor_y = std::pow(1.2, (double) -mouse_wheel_delta * SCROLL_ZOOM_FACTOR);
+    // Moves the oldest chunk which is still in memory into the spill file, which is created in 'directory' if needed.
+    bool spill_chunk(const char* directory) {
+        assert(can_spill());
+#ifdef _WIN32
+        (void) directory;
+        return false;
+#else
+        if (spill_file < 0) {
+            std::string path = std::string(directory) + "/plotlib-spill-XXXXXX";
+            spill_file = mkstemp(&path[0]);
+            if (spill_file < 0) {
+                printf(ERROR "Failed to create a spill file in '%s': %s.\n", directory, strerror(errno));
+                return false;
+            }
+            unlink(path.c_str());
+        }
+        uint8_t* chunk = chunks[spilled_count].values;
+        uint64_t file_offset = spill_file_length * chunk_size();
+        for (uint64_t written = 0; written < chunk_size();) {
+            ssize_t result = pwrite(spill_file, chunk + written, chunk_size() - written, file_offset + written);
+            if (result < 0 && errno == EINTR) continue;
+            if (result <= 0) {
+                printf(ERROR "Failed to write to the spill file: %s.\n", strerror(errno));
+                return false;
+            }
+            written += result;
+        }
+        void* mapping = mmap(nullptr, chunk_size(), PROT_READ | PROT_WRITE, MAP_SHARED, spill_file, file_offset);
+        if (mapping == MAP_FAILED) {
+            printf(ERROR "Failed to map the spill file: %s.\n", strerror(errno));
+            return false;
+        }
+        free(chunk);
+        chunks[spilled_count].values = (uint8_t*) mapping;
+        ++spilled_count;
+        ++spill_file_length;
+        return true;
+#endif
+    }
 
-    if (rl::IsKeyDown(rl::KEY_LEFT_CONTROL)) {
-        zoom_factor_x = 1.0;
+    // Drops the first 'count' values in constant time, the memory is reused once the buffer has to grow.
+    // Chunks are freed once all of their values were dropped.
+    void erase_front(uint64_t count) {
+        assert(count <= length);
+        uint64_t contiguous_count = std::min(count, contiguous_length);
+        values += contiguous_count * sample_size;
+        contiguous_length -= contiguous_count;
+        length -= count;
+        chunk_head += count - contiguous_count;
+        if (length == 0) {
+            values = allocation;
+            free_chunks(0);
+            chunk_head = 0;
+            return;
+        }
+        if (contiguous_length == 0 && !chunks.empty()) {
+            free(allocation);
+            values = allocation = nullptr;
+            allocation_length = 0;
+            borrowed.reset();
+        }
+        uint64_t freed_count = chunk_head >> CHUNK_SHIFT;
+        if (freed_count > 0) {
+            free_front_chunks(freed_count);
+            chunk_head &= CHUNK_LENGTH - 1;
+        }
     }
-    
-    if (rl::IsKeyDown(rl::KEY_LEFT_SHIFT)) {
-        zoom_factor_y = 1.0;
+
+    // Drops the 'count' values at 'begin'.
+    void erase(uint64_t begin, uint64_t count) {
+        assert(begin + count <= length);
+        if (borrowed && begin + count < length && begin < contiguous_length) {
+            copy_borrowed_values();
+        }
+        uint64_t destination_run, source_run;
+        for (uint64_t destination = begin, source = begin + count; source < length;) {
+            uint8_t* destination_values = locate_for_write(destination, &destination_run);
+            const uint8_t* source_values = locate(source, &source_run);
+            uint64_t run_length = std::min(std::min(destination_run, source_run), length - source);
+            memmove(destination_values, source_values, run_length * sample_size);
+            destination += run_length;
+            source += run_length;
+        }
+        resize(length - count);
     }
 
-    if (mouse_wheel_delta) {
-        gps.gui.zoom_resize_cooldown = 2;
+    // Makes the borrowed contiguous values owned, without moving the chunks.
+    void copy_borrowed_values() {
+        uint8_t* owned_values = (uint8_t*) malloc(std::max<uint64_t>(contiguous_length, 1) * sample_size);
+        if (contiguous_length > 0) memcpy(owned_values, values, contiguous_length * sample_size);
+        values = allocation = owned_values;
+        allocation_length = contiguous_length;
+        borrowed.reset();
     }
 
-    auto x_to_screenspace = [=](double x) -> float {
-        return linear_map(x, plot_range.x_begin, plot_range.x_end, (double) plot_screen.x, (double) plot_screen.x + plot_screen.width);
-    };
+    void clear() {
+        borrowed.reset();
+        values = allocation;
+        contiguous_length = length = 0;
+        free_chunks(0);
+        chunk_head = 0;
+    }
 
-    auto y_to_screenspace = [=](double y) -> float {
-        return linear_map(y, plot_range.y_begin, plot_range.y_end, (double) plot_screen.y + plot_screen.height, (double) plot_screen.y);
-    };
+    // Like clear, but also gives the owned memory back.
+    void deallocate() {
+        free(allocation);
+        values = allocation = nullptr;
+        contiguous_length = length = allocation_length = 0;
+        borrowed.reset();
+        free_chunks(0);
+        chunk_head = 0;
+    }
 
-    rl::Vector2 mouse_pos = rl::GetMousePosition();
-    double zoom_center_x = x_to_plotspace(mouse_pos.x);
-    double zoom_center_y = y_to_plotspace(mouse_pos.y);
+    // Gives back the owned memory beyond the contiguous values and the decompressed chunks.
+    void shrink_to_fit() {
+        drop_cache();
+        if (borrowed || allocation_length == contiguous_length) return;
+        if (contiguous_length == 0) {
+            free(allocation);
+            values = allocation = nullptr;
+            allocation_length = 0;
+            return;
+        }
+        if (values != allocation) {
+            memmove(allocation, values, contiguous_length * sample_size);
+        }
+        values = allocation = (uint8_t*) realloc(allocation, contiguous_length * sample_size);
+        allocation_length = contiguous_length;
+    }
 
-    // prefer zooming to the origin / to the x=0, y=0 coordinate axes
-    if (std::abs(x_to_screenspace(0) - mouse_pos.x) < gps.gui.zoom_to_zero_pixel_distance_threshold) {
-        zoom_center_x = 0;
+    void borrow(const double* borrowed_values, uint64_t borrowed_length, std::shared_ptr<Borrowed_Memory> memory) {
+        assert(!is_encoded());
+        deallocate();
+        values = (uint8_t*) const_cast<double*>(borrowed_values);
+        contiguous_length = length = borrowed_length;
+        borrowed = std::move(memory);
     }
 
-    if (std::abs(y_to_screenspace(0) - mouse_pos.y) < gps.gui.zoom_to_zero_pixel_distance_threshold) {
-        zoom_center_y = 0;
+    // Stores the values with 'new_encoding' from now on, the current values are converted.
+    void set_encoding(Sample_Encoding new_encoding) {
+        Sample_Buffer converted(grows_in_chunks);
+        converted.encoding = new_encoding;
+        converted.sample_size = sample_type_size(new_encoding.sample_type);
+        converted.resize(length);
+
+        double scratch[READ_BLOCK_LENGTH];
+        for (uint64_t begin = 0; begin < length; begin += READ_BLOCK_LENGTH) {
+            uint64_t count = std::min<uint64_t>(READ_BLOCK_LENGTH, length - begin);
+            converted.write(begin, read(begin, count, scratch), 1, count);
+        }
+        swap(converted);
     }
+};
 
-    // xy = zoom_matrix * (xy - mouse_pos) + mouse_pos + mouse_pan
-    plot_range.x_begin = zoom_factor_x * (plot_range.x_begin - zoom_center_x) + zoom_center_x + plot_space_pan_x;
-    plot_range.x_end = zoom_factor_x * (plot_range.x_end - zoom_center_x) + zoom_center_x + plot_space_pan_x;
-    plot_range.y_begin = zoom_factor_y * (plot_range.y_begin - zoom_center_y) + zoom_center_y + plot_space_pan_y;
-    plot_range.y_end = zoom_factor_y * (plot_range.y_end - zoom_center_y) + zoom_center_y + plot_space_pan_y;
+// Copies 'count' dense samples, which are already encoded like the values of 'buffer', into [begin, begin + count).
+static void write_encoded_samples(Sample_Buffer& buffer, uint64_t begin, const uint8_t* samples, uint64_t count)
+{
+    uint64_t run_length;
+    for (uint64_t done = 0; done < count; done += run_length) {
+        uint8_t* run = buffer.locate_for_write(begin + done, &run_length);
+        run_length = std::min(run_length, count - done);
+        memcpy(run, samples + done * buffer.sample_size, run_length * buffer.sample_size);
+    }
 }
 
-struct Ticks {
-    int x_count = 0;
-    int y_count = 0;
+// Converts 'count' samples, 'stride' bytes apart, into the values [begin, begin + count) of 'buffer'.
+static void write_samples(Sample_Buffer& buffer, uint64_t begin, const uint8_t* samples, uint32_t sample_type, uint64_t stride, uint64_t count)
+{
+    if (!buffer.is_encoded()) {
+        uint64_t run_length;
+        for (uint64_t done = 0; done < count; done += run_length) {
+            double* values = (double*) buffer.locate_for_write(begin + done, &run_length);
+            run_length = std::min(run_length, count - done);
+            convert_samples_to_double(samples + done * stride, sample_type, stride, run_length, values);
+        }
+        return;
+    }
+    double scratch[READ_BLOCK_LENGTH];
+    for (uint64_t done = 0; done < count; done += READ_BLOCK_LENGTH) {
+        uint64_t block_length = std::min<uint64_t>(READ_BLOCK_LENGTH, count - done);
+        convert_samples_to_double(samples + done * stride, sample_type, stride, block_length, scratch);
+        buffer.write(begin + done, scratch, 1, block_length);
+    }
+}
 
-    double x_spacing;
-    double x_begin;
-    double y_spacing;
-    double y_begin;
+// Reads the values of a Sample_Buffer one at a time, encoded values are decoded block by block.
+struct Sample_Reader {
+    const Sample_Buffer& buffer;
+    const double* block = nullptr;
+    uint64_t block_begin = 0;
+    uint64_t block_end = 0;
+    double scratch[READ_BLOCK_LENGTH];
+
+    Sample_Reader(const Sample_Buffer& buffer) : buffer(buffer) {}
+
+    double operator[](uint64_t i) {
+        if (i < block_begin || i >= block_end) {
+            block_begin = i;
+            block_end = std::min<uint64_t>(i + READ_BLOCK_LENGTH, buffer.size());
+            block = buffer.read(block_begin, block_end - block_begin, scratch);
+        }
+        return block[i - block_begin];
+    }
+};
 
-    char x_text[MAX_TICK_MARK_COUNT][MAX_TICK_MARK_TEXT_LENGTH];
-    char y_text[MAX_TICK_MARK_COUNT][MAX_TICK_MARK_TEXT_LENGTH];
-    float x_text_width[MAX_TICK_MARK_COUNT];
-    float x_text_width_max = 0;
-    float y_text_width[MAX_TICK_MARK_COUNT];
-    float y_text_width_max = 0;
+// A shared-memory ring written by another process, see 'plotlib_shm_header'. The header values are copied when attaching,
+// only the 'write_cursor' is read again.
+struct Shm_Ring {
+    void* mapping = nullptr;
+    uint64_t mapping_size = 0;
+    const plotlib_shm_header* header = nullptr;
+    const uint8_t* data = nullptr;
+
+    uint32_t sample_type = PLOTLIB_SAMPLE_F64;
+    uint64_t sample_size = 0;
+    uint64_t values_per_slot = 1; // 2 for points
+    uint64_t capacity = 0;
+
+    uint64_t read_cursor = 0; // only used by the gui-thread
+    std::atomic<uint64_t> dropped_count { 0 };
+
+    ~Shm_Ring() {
+#ifndef _WIN32
+        if (mapping) munmap(mapping, mapping_size);
+#endif
+    }
+
+    uint64_t load_write_cursor() {
+        return __atomic_load_n(&header->write_cursor, __ATOMIC_ACQUIRE);
+    }
 };
 
-static void gui_generate_ticks(Ticks& ticks, rl::Rectangle bounds, Range_XY plot_range, int x_pixels_per_tick = gps.gui.x_pixels_per_tick)
-{
-    auto calculate_tick_spacing = [](double begin, double end, int tick_count) -> double {
-        double raw_step = (end - begin) / tick_count;
-        double exponent = std::floor(std::log10(raw_step));
-        double base = std::pow(10, exponent);
-        double fraction = raw_step / base;
-        const double nice_fractions[] = {1, 2, 2.5, 5, 10};
-        double best_fraction = 1;
-        for (size_t i = 0; i < sizeof(nice_fractions) / sizeof(double); ++i) {
-            if (fraction <= nice_fractions[i]) {
-                best_fraction = nice_fractions[i];
-                break;
-            }
-        }
-        return best_fraction * base;
+// How many values a plot keeps, the oldest values are evicted every frame. 0 means unbounded.
+struct Retention {
+    uint64_t max_count = 0;
+    double x_range = 0; // the values within this distance to the x of the newest value are kept
+
+    bool bounded() const { return max_count > 0 || x_range > 0; }
+};
+
+// The numbers of a plot are at the x values 'x0 + i * dx', 'i' counts from the first value ever appended.
+struct Implicit_X {
+    double x0 = 0;
+    double dx = 1;
+};
+
+struct Block_Bounds {
+    Range_XY bb;
+    Point first;
+    Point last;
+};
+
+struct Bounds_Level {
+    uint64_t first = 0; // the node 'nodes[0]' is
+    std::vector<Range_XY> nodes;
+};
+
+// Whether the x values of a plot don't decrease, then the first value shown with SHOW_X_RANGE_OF_TAIL is binary searched.
+// The values are checked as they are appended, once the plot is shown in that mode, and NaNs count as decreasing.
+struct X_Order {
+    bool monotonic = true;
+    uint64_t checked_until = 0; // the x values before this were checked
+    double last = -INFINITY; // the last checked x value
+
+    void reset() {
+        monotonic = true;
+        checked_until = 0;
+        last = -INFINITY;
+    }
+};
+
+// The extrema of the last 'window' values of a plot for SHOW_N_POINTS_OF_TAIL. Every deque holds the values which can still
+// become the extremum once the values before them leave the window, in order. Each value is pushed and popped once, so keeping
+// them costs O(1) amortized per appended value and the tail's bounding box is read from the fronts.
+struct Tail_Bounds {
+    struct Entry {
+        uint64_t idx; // counted from the first value ever appended
+        double value;
     };
+    std::deque<Entry> y_min, y_max, x_min, x_max; // the x deques stay empty for implicit x values
+    uint64_t window = 0; // 0 -> not tracked
+    uint64_t tracked_until = 0; // the values before this were pushed
 
-    auto remove_excessive_trailing_zeros = [](char* number_str, int max_len){
-        int true_len = strnlen(number_str, max_len);
-        if (true_len <= 0) return;
+    void reset() {
+        y_min.clear(); y_max.clear(); x_min.clear(); x_max.clear();
+        y_min.shrink_to_fit(); y_max.shrink_to_fit(); x_min.shrink_to_fit(); x_max.shrink_to_fit();
+        window = 0;
+        tracked_until = 0;
+    }
+};
 
-        int trailing_zeros_cnt = 0;
-        int str_idx = true_len;
-        while (str_idx > 0 && number_str[--str_idx] == '0') ++trailing_zeros_cnt;
+struct Plot {
+    Sample_Buffer points_x{true};
+    Sample_Buffer points_y{true};
+
+    Retention retention;
+    bool compressed = false; // the chunks which are no longer appended to are compressed
+    bool queued_for_compression = false; // in 'gps.compression_queue'
+    uint64_t evicted_count = 0; // the index of the first value, values are counted from the first one ever appended
+
+    // Numbers have no stored x values. Points whose x values are uniformly spaced are stored the same way, with an implicit x
+    // computed from their index, until a point which doesn't continue the spacing is appended.
+    Implicit_X implicit_x;
+    bool implicit_points = false;
+
+    // The bounds of blocks of BOUNDS_BLOCK_LENGTH values, only kept for plots with a retention or with values in chunks.
+    // Evicting values then only rescans the first block instead of all values, and rendering skips the blocks outside of the
+    // view and draws blocks narrower than a pixel from their bounds, without reading their values.
+    std::vector<Block_Bounds> block_bounds;
+    uint64_t first_block = 0; // the block 'block_bounds[0]' is, block 'b' holds the values [b, b + 1) * BOUNDS_BLOCK_LENGTH
+    uint64_t bounded_until = 0; // the values before this are included in 'block_bounds'
+    // The levels of a min/max tree above the block bounds, node 'j' of 'bounds_tree[k]' bounds the blocks [j, j + 1) * 2^(k + 1).
+    // The nodes are aligned to the blocks counted from the first value ever appended, the top level has a single node.
+    std::vector<Bounds_Level> bounds_tree;
+
+    Tail_Bounds tail_bounds; // only tracked while the plot is shown with SHOW_N_POINTS_OF_TAIL, reset when values are replaced
+    X_Order x_order; // only checked while the plot is shown with SHOW_X_RANGE_OF_TAIL, reset when values are replaced
+
+    std::shared_ptr<Shm_Ring> shm_ring; // drained every frame
 
-        if (trailing_zeros_cnt >= EXCESSIVE_TRAILING_ZEROS_THRESHOLD) {
-            snprintf(&number_str[str_idx + 1], max_len - str_idx, "+e%d", trailing_zeros_cnt);
-        }
+    Color color;
+    bool show_lines = true;
+    double line_width = 1.0;
+    bool show_points = false;
+    double point_diameter = 3.0;
+    
+    bool initialized = false;
+    
+    char* label = nullptr;
+    
+    Range_XY bb = { MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE }; // bounding box
+    
+    bool has_x_coordinate() { return !points_x.empty() && points_x.size() == points_y.size(); }
+    double implicit_x_of(uint64_t i) { return implicit_x.x0 + (evicted_count + i) * implicit_x.dx; }
+    double implicit_index_of(double x) { return (x - implicit_x.x0) / implicit_x.dx - evicted_count; } // fractional
+    bool is_timestamped() { return points_x.encoding.sample_type == PLOTLIB_SAMPLE_I64; }
+    bool empty() { return points_x.empty() && points_y.empty(); }
+};
+
+// Single-producer/single-consumer ring which the append functions write into without taking any lock.
+// The producer is the (one) thread appending to the plot, the consumer is the gui-thread.
+struct Append_Ring {
+    enum : uint32_t {
+        EMPTY,
+        NUMBERS,
+        POINTS,
     };
 
-    ticks.x_count = std::min((int) std::floor(bounds.width / x_pixels_per_tick), MAX_TICK_MARK_COUNT);
-    ticks.y_count = std::min((int) std::floor(bounds.height / gps.gui.y_pixels_per_tick), MAX_TICK_MARK_COUNT);
+    Point* slots = nullptr;
+    uint64_t capacity = 0; // always a power of two
+    uint64_t mask = 0;
 
-    ticks.x_spacing = calculate_tick_spacing(plot_range.x_begin, plot_range.x_end, ticks.x_count);
-    ticks.x_begin = ceil(plot_range.x_begin / ticks.x_spacing) * ticks.x_spacing;
-    ticks.y_spacing = calculate_tick_spacing(plot_range.y_begin, plot_range.y_end, ticks.y_count);
-    ticks.y_begin = ceil(plot_range.y_begin / ticks.y_spacing) * ticks.y_spacing;
+    std::atomic<uint32_t> kind { EMPTY }; // what the producer has pushed since the plot was cleared, they can't be mixed
+    std::atomic<uint64_t> dropped_count { 0 };
 
-    int tick_idx = 0;
-    for (double x = ticks.x_begin; x < plot_range.x_end && tick_idx < MAX_TICK_MARK_COUNT; x += ticks.x_spacing, ++tick_idx) {
-        // this is a stupid hack to make sure 0 is dispayed cleanly, it works because 0 is always included as a tick,
-        // if 0 is in the plot_range. So we can find it easily by comparing x to the tick-spacing
-        if (std::abs(x) < ticks.x_spacing * 1e-3) x = 0.0;
-        
-        snprintf(ticks.x_text[tick_idx], MAX_TICK_MARK_TEXT_LENGTH, "%.14g", x);
-        remove_excessive_trailing_zeros(ticks.x_text[tick_idx], MAX_TICK_MARK_TEXT_LENGTH);
-        ticks.x_text_width[tick_idx] = MeasureTextEx(gps.gui.font_normal, ticks.x_text[tick_idx], gps.gui.fontsize_normal, gps.gui.fontspacing).x;
-        ticks.x_text_width_max = ticks.x_text_width[tick_idx] > ticks.x_text_width_max ? ticks.x_text_width[tick_idx] : ticks.x_text_width_max;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head { 0 }; // written by the producer
+    uint64_t producer_cached_tail = 0;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail { 0 }; // written by the consumer
+    uint64_t consumer_reported_dropped_count = 0;
+    bool consumer_drained_since_clear = false; // the plot holds values of the ring since it was last cleared or filled
+    std::atomic<uint64_t> kind_reset_at { 0 }; // the tail when nothing was drained since the last clear or fill, or NOT_RESET
+    uint64_t consumer_drain_until = 0; // the head when the staged updates were taken, later values belong to the next frame
+
+    Append_Ring(uint64_t min_capacity) {
+        capacity = 1;
+        while (capacity < min_capacity) capacity <<= 1;
+        mask = capacity - 1;
+        slots = new Point[capacity];
     }
 
-    // Regenerate the ticks if the text is too wide.
-    if (ticks.x_text_width_max > x_pixels_per_tick && x_pixels_per_tick < 1000) {
-        gui_generate_ticks(ticks, bounds, plot_range, x_pixels_per_tick * 2);
-        return;
+    ~Append_Ring() {
+        delete[] slots;
     }
 
-    tick_idx = 0;
-    for (double y = ticks.y_begin; y < plot_range.y_end && tick_idx < MAX_TICK_MARK_COUNT; y += ticks.y_spacing, ++tick_idx) {
-        if (std::abs(y) < ticks.y_spacing * 1e-3) y = 0.0;
-        snprintf(ticks.y_text[tick_idx], MAX_TICK_MARK_TEXT_LENGTH, "%.14g", y);
-        remove_excessive_trailing_zeros(ticks.y_text[tick_idx], MAX_TICK_MARK_TEXT_LENGTH);
-        ticks.y_text_width[tick_idx] = MeasureTextEx(gps.gui.font_normal, ticks.y_text[tick_idx], gps.gui.fontsize_normal, gps.gui.fontspacing).x;
-        ticks.y_text_width_max = ticks.y_text_width[tick_idx] > ticks.y_text_width_max ? ticks.y_text_width[tick_idx] : ticks.y_text_width_max;
+    static constexpr uint64_t NOT_RESET = UINT64_MAX;
+
+    // Only called by the producer, the first push decides whether the ring holds numbers or points. Once the plot was cleared
+    // or filled and every value pushed before was drained, the next push decides again.
+    bool accepts(uint32_t push_kind) {
+        uint32_t current_kind = kind.load(std::memory_order_relaxed);
+        if (current_kind == EMPTY ||
+            (current_kind != push_kind && head.load(std::memory_order_relaxed) == kind_reset_at.load(std::memory_order_acquire))) {
+            kind.store(push_kind, std::memory_order_relaxed);
+            return true;
+        }
+        return current_kind == push_kind;
     }
-}
 
-void gui_loop()
-{
-    Range_XY& plot_range = gps.plot_range;
-    rl::Rectangle& plot_screen = gps.plot_screen;
-    
-    while (true)
-    {
-        apply_and_reset_gps_update();
-                
-        if (!gps.window_is_init && gps.window_visible) {
-            rl::SetConfigFlags(rl::FLAG_WINDOW_RESIZABLE);
-            rl::SetTraceLogLevel(rl::LOG_ERROR);
-            rl::InitWindow(gps.gui.window_width, gps.gui.window_height, "Plotlib");
-            rl::SetTargetFPS(gps.gui.target_fps);
-            gps.gui.font_normal = rl::LoadFontFromMemory(".ttf", gui_font_binary_ttf, gui_font_binary_ttf_len, gps.gui.fontsize_normal, nullptr, 0);
-            gps.gui.font_large = rl::LoadFontFromMemory(".ttf", gui_font_binary_ttf, gui_font_binary_ttf_len, gps.gui.fontsize_large, nullptr, 0);
-            gps.window_is_init = true;
+    // Pushes all 'count' values or none of them. 'x' is null for numbers. Never blocks, returns false if the ring is full.
+    // 'x_stride' and 'y_stride' are in doubles.
+    bool push(const double* x, uint64_t x_stride, const double* y, uint64_t y_stride, uint64_t count) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (h + count - producer_cached_tail > capacity) {
+            producer_cached_tail = tail.load(std::memory_order_acquire);
+            if (h + count - producer_cached_tail > capacity) {
+                dropped_count.fetch_add(count, std::memory_order_relaxed);
+                return false;
+            }
         }
 
-        if (gps.window_is_init && (rl::WindowShouldClose() || gps.terminate)) {
-            rl::CloseWindow();
-            gps.window_is_init = false;
-            gps.window_visible = false;
-            gps.terminate = false;
-            
-            // This is a special occasions where we need to mutate the 'gps_update' from within the gui-thread.
-            // Overwriting the commands from the api-functions like this should only happen when absolutely necessary.
-            gps_update_mutex.lock();
-            gps_update.window_visible = false;
-            gps_update_mutex.unlock();
-            gps.window_visible = false;
-
-            std::this_thread::sleep_for(std::chrono::microseconds(1000));
-            continue;
+        for (uint64_t i = 0; i < count; ++i) {
+            Point& slot = slots[(h + i) & mask];
+            slot.x = x ? x[i * x_stride] : 0;
+            slot.y = y[i * y_stride];
         }
+        head.store(h + count, std::memory_order_release);
+        return true;
+    }
+};
 
-        if (!gps.window_visible) {
-            std::this_thread::sleep_for(std::chrono::microseconds(1000));
-            continue;
+// Bounds how many values can be staged for a plot between two frames, see the PLOTLIB_STAGING_* policies.
+struct Staging_Limit {
+    uint32_t policy = PLOTLIB_STAGING_UNBOUNDED;
+    uint64_t max_values = 0;
+};
+
+// The storage of all plots beyond 'max_resident_bytes' is spilled to files in 'directory', see 'plotlib_set_spill_limit'.
+struct Spill_Limit {
+    uint64_t max_resident_bytes = 0; // 0 -> nothing is spilled
+    std::string directory;
+};
+
+// Once the plots hold more than 'max_bytes', see 'plotlib_set_memory_limit' and the PLOTLIB_MEMORY_* policies.
+struct Memory_Limit {
+    uint64_t max_bytes = 0; // 0 -> unlimited
+    uint32_t policy = PLOTLIB_MEMORY_SHRINK;
+};
+
+// The memory of a plot as of the last frame, the gui-thread publishes it for the api functions which read it without a lock.
+struct Plot_Memory {
+    std::atomic<uint64_t> live_bytes { 0 };
+    std::atomic<uint64_t> capacity_bytes { 0 };
+    std::atomic<uint64_t> taken_bytes { 0 }; // the staging buffers on the side of the gui-thread
+};
+
+struct Plot_Update {
+    Sample_Buffer new_points_x;
+    Sample_Buffer new_points_y;
+
+    std::atomic<Append_Ring*> append_ring { nullptr }; // only set once, is never freed
+    uint64_t ring_discard_until = 0; // ring entries before this position were pushed before the plot was cleared
+
+    bool has_custom_color = false;
+    Color custom_color;
+    bool show_lines = true;
+    double line_width = 1.0;
+    bool show_points = false;
+    double point_diameter = 3.0;
+    char* new_name = nullptr;
+
+    bool empty_update = true; // true -> safe to skip the update
+    bool was_cleared = false;
+
+    bool contains_points = false;
+    bool contains_numbers = false;
+
+    bool shm_ring_changed = false;
+    std::shared_ptr<Shm_Ring> new_shm_ring; // null -> detach
+
+    bool storage_changed = false;
+    Sample_Encoding storage_encoding; // how the plot stores its y values, the staged y values are always doubles
+    bool x_storage_changed = false;
+    Sample_Encoding x_storage_encoding; // the staged x values are doubles, or timestamps which are staged with this encoding
+
+    bool retention_changed = false;
+    Retention retention;
+
+    bool compression_changed = false;
+    bool compressed = false;
+
+    bool implicit_x_changed = false;
+    Implicit_X implicit_x; // the x of the numbers, mirrors the setting
+
+    // The bounding box of the first 'bounded_length' staged values, if it was already computed while loading them.
+    Range_XY bounding_box;
+    uint64_t bounded_length = 0;
+
+    // How many values the buffers held when the gui-thread last reset them, it tells if they are worth keeping.
+    uint64_t merged_length = 0;
+
+    // These belong to the staging side and aren't taken by the gui-thread.
+    bool has_staging_limit = false; // false -> the global 'staging_limit' applies
+    Staging_Limit staging_limit;
+    uint64_t dropped_count = 0;
+    std::shared_ptr<Shm_Ring> shm_ring; // the currently attached ring
+    bool timestamped = false; // the x values are stored as timestamps, until the plot is cleared or filled otherwise
+
+    bool accepts_numbers() { return contains_numbers || !contains_points; }
+    bool accepts_points() { return contains_points || !contains_numbers; }
+    
+    // Resets everything which was just a delta and not a mirror of the actual state.
+    void reset() {
+        merged_length = new_points_y.size();
+        new_points_x.clear();
+        new_points_y.clear();
+        has_custom_color = false;
+        
+        delete[] new_name;
+        new_name = nullptr;
+        
+        ring_discard_until = 0;
+        shm_ring_changed = false;
+        new_shm_ring.reset();
+        storage_changed = false;
+        x_storage_changed = false;
+        retention_changed = false;
+        compression_changed = false;
+        implicit_x_changed = false;
+        bounded_length = 0;
+        was_cleared = false;
+        empty_update = true;
+    }
+
+    // Hands the update over to the gui-thread in constant time. The staged buffers are swapped with the ones in 'taken',
+    // which were reset after the last merge, so both sides keep reusing their memory.
+    void take_into(Plot_Update& taken) {
+        assert(taken.empty_update);
+        taken.new_points_x.swap(new_points_x);
+        taken.new_points_y.swap(new_points_y);
+        taken.ring_discard_until = ring_discard_until;
+        taken.has_custom_color = has_custom_color;
+        taken.custom_color = custom_color;
+        taken.show_lines = show_lines;
+        taken.line_width = line_width;
+        taken.show_points = show_points;
+        taken.point_diameter = point_diameter;
+        std::swap(taken.new_name, new_name);
+        taken.empty_update = empty_update;
+        taken.was_cleared = was_cleared;
+        taken.contains_points = contains_points;
+        taken.contains_numbers = contains_numbers;
+        taken.shm_ring_changed = shm_ring_changed;
+        taken.new_shm_ring.swap(new_shm_ring);
+        taken.storage_changed = storage_changed;
+        taken.storage_encoding = storage_encoding;
+        taken.x_storage_changed = x_storage_changed;
+        taken.x_storage_encoding = x_storage_encoding;
+        taken.retention_changed = retention_changed;
+        taken.retention = retention;
+        taken.compression_changed = compression_changed;
+        taken.compressed = compressed;
+        taken.implicit_x_changed = implicit_x_changed;
+        taken.implicit_x = implicit_x;
+        taken.bounding_box = bounding_box;
+        taken.bounded_length = bounded_length;
+        reset();
+    }
+
+    void clear_plot() {
+        new_points_x.clear();
+        new_points_y.clear();
+        Append_Ring* ring = append_ring.load(std::memory_order_acquire);
+        if (ring) {
+            ring_discard_until = ring->head.load(std::memory_order_acquire);
+        }
+        contains_points = false;
+        contains_numbers = false;
+        bounded_length = 0;
+        was_cleared = true;
+        if (timestamped) { // the new values have double x values again, unless they are timestamped too
+            timestamped = false;
+            x_storage_changed = true;
+            x_storage_encoding = Sample_Encoding{};
         }
+    }
+};
 
-        gps.gui.window_width = rl::GetScreenWidth();
-        gps.gui.window_height = rl::GetScreenHeight();
+struct Plot_Group {
+    std::vector<Plot_IDX> plots;
+    char* label = nullptr;
+    bool initialized = false;
+};
 
-        rl::Rectangle bounds = {0, 0, (float) gps.gui.window_width, (float) gps.gui.window_height};
+struct Plot_Group_Update {
+    std::vector<Plot_IDX> new_plots;
+    std::vector<Plot_IDX> remove_plots;
+    
+    char* new_name = nullptr;
+    
+    bool empty_update = true;
+    bool was_cleared = false;
 
-        rl::BeginDrawing();
-        {
-            Plot_Group& group = gps.plot_groups[gps.visible_group];
+    void reset() {
+        new_plots.clear();
+        remove_plots.clear();
 
-            // Draw Background
+        delete[] new_name;
+        new_name = nullptr;
+        
+        was_cleared = false;
+        empty_update = true;
+    }
 
-            rl::DrawRectangleRec(bounds, gps.gui.colors.backgound);
+    void take_into(Plot_Group_Update& taken) {
+        assert(taken.empty_update);
+        taken.new_plots.swap(new_plots);
+        taken.remove_plots.swap(remove_plots);
+        std::swap(taken.new_name, new_name);
+        taken.empty_update = empty_update;
+        taken.was_cleared = was_cleared;
+        reset();
+    }
 
-            // Determine the plot range (The xy-range in plotspace that should be displayed)
+    void clear_group() {
+        new_plots.clear();
+        remove_plots.clear();
+        was_cleared = true;
+    }
+};
 
-            switch (gps.vis_mode.type) {
-            case Visualization_Mode::INTERACTIVE:
-                gui_update_plot_range_interactive_mode(plot_range, plot_screen);
-                break;
-            case Visualization_Mode::SHOW_ENTIRE_PLOT_GROUP:
-                plot_range = bounding_box_of_plots_bounding_boxes(group.plots);
-                break;
-            case Visualization_Mode::SHOW_X_RANGE_OF_TAIL:
-                plot_range = bounding_box_of_plots_bounding_boxes(group.plots);
-                plot_range.x_begin = plot_range.x_end - gps.vis_mode.x_range;
-                break;
-            case Visualization_Mode::SHOW_N_POINTS_OF_TAIL:
-            {
-                std::vector<Range_XY> bounding_boxes(group.plots.size());
-                for (uint64_t i = 0; i < group.plots.size(); ++i) {
-                    Plot& plot = gps.plots[group.plots[i]];
-                    uint64_t plot_points_begin_idx = 0;
-                    if (gps.vis_mode.n_points < plot.points_y.size()) {
-                        plot_points_begin_idx = plot.points_y.size() - gps.vis_mode.n_points;
-                    }
-                    bounding_boxes[i] = bounding_box_of_plot(plot, plot_points_begin_idx);
-                }
-                plot_range = bounding_box_of_bounding_boxes(bounding_boxes);
-            }
-            break;
-            case Visualization_Mode::SHOW_SPECIFIC_PLOT:
-                assert(gps.vis_mode.specific_plot != INVALID_IDX);
-                plot_range = bounding_box_of_plot(gps.plots[gps.vis_mode.specific_plot], 0);
-                break;
-            }
+struct Theme_Colors {
+    rl::Color text;
+    rl::Color backgound;
+    rl::Color tick_lines;
+    rl::Color coordinate_axes;
+    rl::Color plot_screen_border;
+};
 
-            // Fix the plot range if it is malformed
+static const Theme_Colors dark_theme_colors = {
+    .text               = { 0xff, 0xff, 0xff, 0xff},
+    .backgound          = { 0x25, 0x25, 0x25, 0xff },
+    .tick_lines         = { 0xff, 0xff, 0xff, 0x10 },
+    .coordinate_axes    = { 0xff, 0xff, 0xff, 0x40 },
+    .plot_screen_border = { 0xff, 0xff, 0xff, 0xff },
+};
 
-            if (plot_range.x_begin == plot_range.x_end) {
-                plot_range.x_begin -= 0.5;
-                plot_range.x_end += 0.5;
-            }
-            else if (plot_range.x_begin > plot_range.x_end) {
-                plot_range.x_begin = -0.5;
-                plot_range.x_end = 0.5;
-            }
-            
-            if (plot_range.y_begin == plot_range.y_end) {
-                plot_range.y_begin -= 0.5;
-                plot_range.y_end += 0.5;
+static const Theme_Colors light_theme_colors = {
+    .text               = { 0x00, 0x00, 0x00, 0xff},
+    .backgound          = { 0xfd, 0xfd, 0xfd, 0xff },
+    .tick_lines         = { 0x00, 0x00, 0x00, 0x10 },
+    .coordinate_axes    = { 0x00, 0x00, 0x00, 0x40 },
+    .plot_screen_border = { 0x00, 0x00, 0x00, 0xff },
+};
+
+struct Gui {
+    int target_fps = DEFAULT_FPS;
+    
+    rl::Font font_normal;
+    rl::Font font_large;
+    float fontsize_normal = 22;
+    float fontsize_large = 24;
+    float fontspacing = 0;
+
+    int window_width = DEFAULT_WINDOW_WIDTH;
+    int window_height = DEFAULT_WINDOW_HEIGHT;
+
+    int x_pixels_per_tick = 50;
+    int y_pixels_per_tick = 50;
+
+    int tick_mark_len = DEFAULT_TICK_MARK_LEN;
+    float plot_screen_border_width = 1;
+
+    float offset_normal = 5;
+    float offset_small = 2;
+
+    float zoom_to_zero_pixel_distance_threshold = DEFAULT_ZOOM_TO_ZERO_PIXEL_DISTANCE_THRESHOLD;
+    int zoom_resize_cooldown = 0;
+
+    Theme_Colors colors;
+};
+
+struct Visualization_Mode {
+    enum : uint32_t {
+        NONE,
+        INTERACTIVE,
+        SHOW_N_POINTS_OF_TAIL,
+        SHOW_X_RANGE_OF_TAIL,
+        SHOW_ENTIRE_PLOT_GROUP,
+        SHOW_SPECIFIC_PLOT,
+    };
+    uint32_t type = NONE;
+    uint64_t n_points = 0;
+    double x_range = 0;
+    Plot_IDX specific_plot = INVALID_IDX;
+};
+
+// The state of every plot, indexed by its plot index. The pages of PLOT_PAGE_LENGTH plots are allocated once one of their
+// plots is used and are never freed, so any thread can look up a plot without a lock and references to it stay valid.
+// Loops over the plots only visit the allocated pages:
+//     for (Plot_IDX plot_idx = table.first(); plot_idx < table.end(); plot_idx = table.next(plot_idx))
+template <typename T>
+struct Plot_Table {
+    std::atomic<T*> pages[MAX_PLOT_HANDLE_COUNT / PLOT_PAGE_LENGTH] = {};
+    std::atomic<uint32_t> page_end { 0 }; // no page after this one is allocated
+
+    T& operator[](Plot_IDX plot_idx) {
+        uint32_t page_idx = plot_idx / PLOT_PAGE_LENGTH;
+        T* page = pages[page_idx].load(std::memory_order_acquire);
+        if (!page) {
+            T* new_page = new T[PLOT_PAGE_LENGTH];
+            if (pages[page_idx].compare_exchange_strong(page, new_page, std::memory_order_acq_rel)) {
+                page = new_page;
             }
-            else if (plot_range.y_begin > plot_range.y_end) {
-                plot_range.y_begin = -0.5;
-                plot_range.y_end = 0.5;
+            else {
+                delete[] new_page; // another thread allocated it first
             }
+            uint32_t end = page_end.load(std::memory_order_relaxed);
+            while (end <= page_idx && !page_end.compare_exchange_weak(end, page_idx + 1, std::memory_order_release)) {}
+        }
+        return page[plot_idx % PLOT_PAGE_LENGTH];
+    }
 
-            auto limit_range_to_tolerable_precision = [](double& range_begin, double& range_end) -> void {
-                double nextafter_begin = std::nextafter(range_begin, std::numeric_limits<double>::infinity());
-                assert(range_end - range_begin  >= 0);
-                assert(nextafter_begin - range_begin >= 0);
-                double precision_correction = (range_end - range_begin) - (nextafter_begin - range_begin) * PRECISION_SAFTEY_FACTOR;
-                if (precision_correction < 0) {
-                    range_begin -= std::abs(precision_correction) / 2.0;
-                    range_end   += std::abs(precision_correction) / 2.0;
-                }  
-            };
+    Plot_IDX end() const { return page_end.load(std::memory_order_acquire) * PLOT_PAGE_LENGTH; }
+    Plot_IDX first() const { return skip_unallocated(0); }
+    Plot_IDX next(Plot_IDX plot_idx) const { return skip_unallocated(plot_idx + 1); }
 
-            limit_range_to_tolerable_precision(plot_range.x_begin, plot_range.x_end);
-            limit_range_to_tolerable_precision(plot_range.y_begin, plot_range.y_end);
+    Plot_IDX skip_unallocated(Plot_IDX plot_idx) const {
+        Plot_IDX table_end = end();
+        while (plot_idx < table_end && plot_idx % PLOT_PAGE_LENGTH == 0) {
+            if (pages[plot_idx / PLOT_PAGE_LENGTH].load(std::memory_order_acquire)) break;
+            plot_idx += PLOT_PAGE_LENGTH;
+        }
+        return plot_idx;
+    }
+};
 
-            // Calculate the tick spacing and generate the tick labels
+struct Plotlib_State {
+    Plot_Table<Plot> plots;
+    Plot_Group plot_groups[MAX_PLOT_GROUP_SIZE];
 
-            Ticks ticks;
-            gui_generate_ticks(ticks, bounds, plot_range);
+    Group_IDX visible_group = DEFAULT_PLOT_GROUP_IDX;
+    Visualization_Mode vis_mode { .type=Visualization_Mode::SHOW_ENTIRE_PLOT_GROUP };
+    
+    Range_XY plot_range = Range_XY{};
+    rl::Rectangle plot_screen = rl::Rectangle{ 0, 0, DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT };
+
+    // The updates which were taken out of 'gps_update' this frame, they are merged after releasing the 'gps_update_mutex'.
+    Plot_Table<Plot_Update> taken_plot_updates;
+    Plot_Group_Update taken_plot_group_updates[MAX_PLOT_GROUP_SIZE];
+    std::vector<Plot_IDX> taken_plots;
+    std::vector<Group_IDX> taken_groups;
+    std::vector<Plot_IDX> append_ring_plots;
+    std::vector<Plot_IDX> shm_ring_plots;
+    std::vector<Plot_IDX> retention_plots;
+    std::vector<Plot_IDX> compression_queue; // compressed plots which were appended to since their chunks were compressed
+    std::vector<Plot_IDX> compacted_plots; // plots whose chunks were compressed or spilled this frame
+    Spill_Limit spill_limit;
+    Memory_Limit memory_limit;
+
+    Gui gui;
+    bool window_is_init = false;
+    bool window_visible = false;
+    bool terminate = false;
+};
+
+// The plot updates are split into shards with their own lock and dirty list, so threads feeding plots of different shards
+// don't contend. A plot belongs to the shard 'plot_idx % PLOT_SHARD_COUNT'.
+struct alignas(CACHE_LINE_SIZE) Plot_Shard {
+    std::mutex mutex;
+    std::vector<Plot_IDX> dirty_plots;
+};
+
+struct Plotlib_State_Update {
+    Plot_Table<Plot_Update> plot_updates; // guarded by the mutex of their shard
+    Plot_Shard plot_shards[PLOT_SHARD_COUNT];
+
+    // Everything below is guarded by the 'gps_update_mutex'.
+
+    Plot_Group_Update plot_group_updates[MAX_PLOT_GROUP_SIZE];
+    
+    Group_IDX visible_group = DEFAULT_PLOT_GROUP_IDX;
+    Visualization_Mode vis_mode { .type=Visualization_Mode::SHOW_ENTIRE_PLOT_GROUP };
+
+    Theme_Colors theme_colors = dark_theme_colors;
+
+    Staging_Limit staging_limit; // is read by the data path, so changing it also takes the lock of every shard
+    Spill_Limit spill_limit;
+    Memory_Limit memory_limit;
+
+    Plot_Table<Plot_Memory> plot_memory; // isn't guarded, only written by the gui-thread
+
+    std::unordered_map<std::string, Plot_IDX> plot_handles; // the handles of 'plot_create' by their name
+
+    std::vector<Plot_IDX> append_ring_plots; // plots which have an 'append_ring', they are drained every frame
+
+    // The indices of all non-empty group updates, so applying them doesn't need to look at every group.
+    std::vector<Group_IDX> dirty_groups;
+
+    std::atomic<bool> window_visible { false }; // is read by the data path without the 'gps_update_mutex'
+    bool terminate = false;
+
+    Plot_Shard& shard_of(Plot_IDX plot_idx) {
+        return plot_shards[plot_idx % PLOT_SHARD_COUNT];
+    }
+
+    void mark_plot_dirty(Plot_IDX plot_idx) {
+        if (plot_updates[plot_idx].empty_update) {
+            plot_updates[plot_idx].empty_update = false;
+            shard_of(plot_idx).dirty_plots.push_back(plot_idx);
+        }
+    }
+
+    void mark_group_dirty(Group_IDX group_idx) {
+        if (plot_group_updates[group_idx].empty_update) {
+            plot_group_updates[group_idx].empty_update = false;
+            dirty_groups.push_back(group_idx);
+        }
+    }
+};
+
+static Plotlib_State gps;
+static Plotlib_State_Update gps_update;
+
+// The timestamp (in nanoseconds) which is x = 0 for every timestamped plot, it is the first timestamp plotted. Their x values
+// are seconds relative to it, so doubles keep nanosecond precision for months around it.
+static std::atomic<int64_t> time_origin { NO_TIME_ORIGIN };
+static std::mutex gps_update_mutex; // guards the global state of 'gps_update', the plot updates are guarded by their shard
+static std::condition_variable_any gps_update_taken; // notified whenever the gui-thread took the staged updates
+// Guards 'gps.plots' against the queries of the api-functions, the gui-thread holds it while applying the updates and drawing.
+// Drawing fills the caches of compressed chunks and the tail bounds, so the queries can't run alongside it and wait for up
+// to a frame. It is taken before the 'gps_update_mutex'.
+static std::mutex plots_mutex;
+
+// Takes the 'gps_update_mutex' and then the lock of every shard. Locks are always taken in this order.
+static void lock_everything()
+{
+    gps_update_mutex.lock();
+    for (uint32_t shard_idx = 0; shard_idx < PLOT_SHARD_COUNT; ++shard_idx) {
+        gps_update.plot_shards[shard_idx].mutex.lock();
+    }
+}
+
+static void unlock_everything()
+{
+    for (uint32_t shard_idx = 0; shard_idx < PLOT_SHARD_COUNT; ++shard_idx) {
+        gps_update.plot_shards[shard_idx].mutex.unlock();
+    }
+    gps_update_mutex.unlock();
+}
+
+static void grow_bounding_box(Range_XY& bb, const Range_XY& other)
+{
+    bb.x_begin = other.x_begin < bb.x_begin ? other.x_begin : bb.x_begin;
+    bb.x_end = other.x_end > bb.x_end ? other.x_end : bb.x_end;
+    bb.y_begin = other.y_begin < bb.y_begin ? other.y_begin : bb.y_begin;
+    bb.y_end = other.y_end > bb.y_end ? other.y_end : bb.y_end;
+}
+
+// The bounding box of the values [begin_idx, end_idx), read on this thread.
+static Range_XY bounding_box_of_chunk(Plot& plot, uint64_t begin_idx, uint64_t end_idx)
+{
+    Range_XY bb = { MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE };
+    bool has_x_coordinate = plot.has_x_coordinate();
+    if (!has_x_coordinate) {
+        bb.x_begin = plot.implicit_x_of(begin_idx);
+        bb.x_end = plot.implicit_x_of(end_idx - 1);
+    }
+    double scratch[READ_BLOCK_LENGTH];
+    for (uint64_t block_begin = begin_idx; block_begin < end_idx; block_begin += READ_BLOCK_LENGTH) {
+        uint64_t block_length = std::min<uint64_t>(READ_BLOCK_LENGTH, end_idx - block_begin);
+        bound_values(plot.points_y.read(block_begin, block_length, scratch), block_length, bb.y_begin, bb.y_end);
+        if (has_x_coordinate) {
+            bound_values(plot.points_x.read(block_begin, block_length, scratch), block_length, bb.x_begin, bb.x_end);
+        }
+    }
+    return bb;
+}
+
+// The threads which bound 'length' values of the plot. Starting them is only worth it for ranges which take many
+// milliseconds to bound, the values appended per frame are bounded on the gui-thread. Reading compressed chunks fills
+// their cache, which isn't thread-safe.
+static uint64_t bounds_thread_count(Plot& plot, uint64_t length)
+{
+    if (length < 2 * MIN_BOUNDS_CHUNK_LENGTH) return 1;
+    if (plot.points_y.compressed_count > 0 || plot.points_x.compressed_count > 0) return 1;
+    uint64_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+    return std::min(thread_count, length / MIN_BOUNDS_CHUNK_LENGTH);
+}
+
+// Calls 'bound_part(i)' for every part i in [0, thread_count), the first part on this thread.
+template <typename Bound_Part>
+static void bound_on_threads(uint64_t thread_count, Bound_Part bound_part)
+{
+    std::vector<std::thread> threads;
+    for (uint64_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(bound_part, i);
+    }
+    bound_part(0);
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+}
+
+// The bounding box of the values [begin_idx, end_idx), large ranges are split over more threads.
+static Range_XY bounding_box_of_values(Plot& plot, uint64_t begin_idx, uint64_t end_idx)
+{
+    uint64_t thread_count = bounds_thread_count(plot, end_idx - begin_idx);
+    if (thread_count == 1) {
+        return bounding_box_of_chunk(plot, begin_idx, end_idx);
+    }
+
+    std::vector<Range_XY> bbs(thread_count);
+    bound_on_threads(thread_count, [&](uint64_t i) {
+        bbs[i] = bounding_box_of_chunk(plot, begin_idx + (end_idx - begin_idx) * i / thread_count,
+                                       begin_idx + (end_idx - begin_idx) * (i + 1) / thread_count);
+    });
+
+    Range_XY bb = bbs[0];
+    for (uint64_t i = 1; i < thread_count; ++i) {
+        grow_bounding_box(bb, bbs[i]);
+    }
+    return bb;
+}
+
+static Range_XY bounding_box_of_plot(Plot& plot, uint64_t begin_idx)
+{
+    return bounding_box_of_values(plot, begin_idx, plot.points_y.size());
+}
+
+// The x range of a plot without x values follows from the number of values, it isn't scanned.
+static void bound_implicit_x(Plot& plot)
+{
+    uint64_t length = plot.points_y.size();
+    plot.bb.x_begin = plot.implicit_x_of(0);
+    plot.bb.x_end = plot.implicit_x_of(length == 0 ? 0 : length - 1);
+}
+
+static Range_XY bounding_box_of_plots_bounding_boxes(std::vector<Plot_IDX>& plots)
+{
+    Range_XY bb = { MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE };
+    for (uint64_t i = 0; i < plots.size(); ++i) {
+        Plot& plot = gps.plots[plots[i]];
+        bb.x_begin = plot.bb.x_begin < bb.x_begin ? plot.bb.x_begin : bb.x_begin;
+        bb.x_end = plot.bb.x_end > bb.x_end ? plot.bb.x_end : bb.x_end;
+        bb.y_begin = plot.bb.y_begin < bb.y_begin ? plot.bb.y_begin : bb.y_begin;
+        bb.y_end = plot.bb.y_end > bb.y_end ? plot.bb.y_end : bb.y_end;
+    }
+    return bb;
+}
+
+static Range_XY bounding_box_of_bounding_boxes(std::vector<Range_XY>& bbs)
+{
+    Range_XY bb = { MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE };
+    for (uint64_t i = 0; i < bbs.size(); ++i) {
+        bb.x_begin = bbs[i].x_begin < bb.x_begin ? bbs[i].x_begin : bb.x_begin;
+        bb.x_end = bbs[i].x_end > bb.x_end ? bbs[i].x_end : bb.x_end;
+        bb.y_begin = bbs[i].y_begin < bb.y_begin ? bbs[i].y_begin : bb.y_begin;
+        bb.y_end = bbs[i].y_end > bb.y_end ? bbs[i].y_end : bb.y_end;
+    }
+    return bb;
+}
+
+static void reset_block_bounds(Plot& plot)
+{
+    plot.block_bounds.clear();
+    plot.bounds_tree.clear();
+    plot.first_block = plot.evicted_count / BOUNDS_BLOCK_LENGTH;
+    plot.bounded_until = plot.evicted_count;
+}
+
+// Puts the staged values at 'offset'. If they replace all values, the staged (possibly borrowed) buffer is taken over instead
+// of copying it. Encoded buffers can't do that, the staged values are always doubles.
+static void merge_values(Sample_Buffer& values, Sample_Buffer& staged, uint64_t offset)
+{
+    if (staged.is_encoded()) { // staged timestamps, they are encoded like the plot's x values and copied as they are
+        assert(staged.encoding.sample_type == values.encoding.sample_type && staged.encoding.origin == values.encoding.origin);
+        if (offset == 0) {
+            values.clear();
+        }
+        values.resize(offset + staged.size());
+        uint64_t run_length;
+        for (uint64_t done = 0; done < staged.size(); done += run_length) {
+            const uint8_t* run = staged.locate(done, &run_length);
+            run_length = std::min(run_length, staged.size() - done);
+            write_encoded_samples(values, offset + done, run, run_length);
+        }
+        return;
+    }
+    if (offset == 0 && !values.is_encoded()) {
+        values.swap(staged);
+        staged.deallocate();
+        return;
+    }
+    if (offset == 0) {
+        values.clear();
+    }
+    if (!staged.empty()) {
+        values.resize(offset + staged.size());
+        values.write(offset, &staged[0], 1, staged.size());
+    }
+}
+
+// Whether the staged x values are spaced uniformly, so the points can be stored without them. Tiny deviations, like the rounding
+// errors of x values which were summed up, are tolerated.
+static bool detect_implicit_x(Sample_Buffer& staged_x, Implicit_X& implicit_x)
+{
+    uint64_t length = staged_x.size();
+    if (length < 2) return false;
+    const double* x = &staged_x[0];
+    double dx = (x[length - 1] - x[0]) / (length - 1);
+    if (!(dx > 0) || !std::isfinite(dx) || !std::isfinite(x[0])) return false;
+    for (uint64_t i = 0; i < length; ++i) {
+        if (!(std::abs(x[i] - (x[0] + i * dx)) <= dx * IMPLICIT_X_TOLERANCE)) return false;
+    }
+    implicit_x = Implicit_X{ x[0], dx };
+    return true;
+}
+
+// Whether the staged x values continue the implicit x of the plot's points, from the value 'offset' on.
+static bool continues_implicit_x(Plot& plot, Sample_Buffer& staged_x, uint64_t offset)
+{
+    if (staged_x.empty()) return true;
+    const double* x = &staged_x[0];
+    for (uint64_t i = 0; i < staged_x.size(); ++i) {
+        if (!(std::abs(x[i] - plot.implicit_x_of(offset + i)) <= plot.implicit_x.dx * IMPLICIT_X_TOLERANCE)) return false;
+    }
+    return true;
+}
+
+// Stores the implicit x values of the plot's points, before points which don't continue their spacing are appended.
+static void make_x_explicit(Plot& plot)
+{
+    uint64_t length = plot.points_y.size();
+    plot.points_x.resize(length);
+    double x[READ_BLOCK_LENGTH];
+    for (uint64_t begin = 0; begin < length; begin += READ_BLOCK_LENGTH) {
+        uint64_t count = std::min<uint64_t>(READ_BLOCK_LENGTH, length - begin);
+        for (uint64_t i = 0; i < count; ++i) {
+            x[i] = plot.implicit_x_of(begin + i);
+        }
+        plot.points_x.write(begin, x, 1, count);
+    }
+    plot.implicit_points = false;
+    plot.tail_bounds.reset(); // it has no deques for the x values yet
+    plot.x_order.reset();
+}
+
+static void merge_plot_update(Plot_IDX plot_idx, Plot_Update& update)
+{
+    Plot& plot = gps.plots[plot_idx];
+
+    if (!plot.initialized) {
+        int label_len = 12; // should be enough for "[plot_idx]"
+        plot.label = new char[label_len];
+        snprintf(plot.label, label_len, "[%d]", plot_idx);
+        plot.label[label_len - 1] = '\0';
+        
+        plot.color = plot_color_table[plot_idx % plot_color_table_size];
+        
+        plot.initialized = true;
+    }
+
+    if (update.has_custom_color) {
+        plot.color = update.custom_color;
+    }
+
+    plot.show_lines = update.show_lines;
+    plot.line_width = update.line_width;
+    plot.show_points = update.show_points;
+    plot.point_diameter = update.point_diameter;
+
+    if (update.new_name) {
+        int label_len = 12 + strlen(update.new_name) + 1;
+        delete[] plot.label;
+        plot.label = new char[label_len];
+        snprintf(plot.label, label_len, "[%d] %s", plot_idx, update.new_name);
+        plot.label[label_len - 1] = '\0';
+    }
+
+    if (update.shm_ring_changed) {
+        if (!plot.shm_ring && update.new_shm_ring) {
+            gps.shm_ring_plots.push_back(plot_idx);
+        }
+        else if (plot.shm_ring && !update.new_shm_ring) {
+            for (size_t i = 0; i < gps.shm_ring_plots.size(); ++i) {
+                if (gps.shm_ring_plots[i] == plot_idx) {
+                    gps.shm_ring_plots.erase(gps.shm_ring_plots.begin() + i);
+                    break;
+                }
+            }
+        }
+        plot.shm_ring = update.new_shm_ring;
+    }
+
+    if (update.retention_changed) {
+        if (!plot.retention.bounded() && update.retention.bounded()) {
+            gps.retention_plots.push_back(plot_idx);
+            reset_block_bounds(plot);
+        }
+        else if (plot.retention.bounded() && !update.retention.bounded()) {
+            for (size_t i = 0; i < gps.retention_plots.size(); ++i) {
+                if (gps.retention_plots[i] == plot_idx) {
+                    gps.retention_plots.erase(gps.retention_plots.begin() + i);
+                    break;
+                }
+            }
+        }
+        plot.retention = update.retention;
+    }
+
+    if (update.compression_changed) {
+        plot.compressed = update.compressed;
+        for (uint64_t i = 0; !plot.compressed && i < plot.points_y.chunks.size(); ++i) {
+            plot.points_y.decompress(i);
+        }
+        for (uint64_t i = 0; !plot.compressed && i < plot.points_x.chunks.size(); ++i) {
+            plot.points_x.decompress(i);
+        }
+    }
+
+    if (update.implicit_x_changed) {
+        if (plot.implicit_points) {
+            make_x_explicit(plot); // the points keep their x values
+        }
+        plot.implicit_x = update.implicit_x;
+        if (!plot.has_x_coordinate()) {
+            bound_implicit_x(plot);
+            reset_block_bounds(plot);
+            plot.tail_bounds.reset();
+        }
+    }
+
+    if (update.storage_changed || update.x_storage_changed) {
+        if (update.x_storage_changed && plot.implicit_points && !update.was_cleared) {
+            make_x_explicit(plot); // encoded x values are always stored
+        }
+        if (update.was_cleared) {
+            plot.points_x.clear();
+            plot.points_y.clear();
+        }
+        if (update.storage_changed) {
+            plot.points_y.set_encoding(update.storage_encoding);
+        }
+        if (update.x_storage_changed) {
+            plot.points_x.set_encoding(update.x_storage_encoding);
+        }
+        if (!plot.points_y.empty()) {
+            plot.bb = bounding_box_of_plot(plot, 0); // the stored values may have been rounded
+        }
+        reset_block_bounds(plot);
+        plot.tail_bounds.reset();
+        plot.x_order.reset();
+    }
+
+    uint64_t old_length = plot.points_y.size();
+    uint64_t new_length = old_length;
+    if (update.was_cleared || old_length == 0) {
+        new_length = 0;
+        plot.bb.x_begin = MAX_PLOTRANGE_VALUE;
+        plot.bb.x_end = -MAX_PLOTRANGE_VALUE;
+        plot.bb.y_begin = MAX_PLOTRANGE_VALUE;
+        plot.bb.y_end = -MAX_PLOTRANGE_VALUE;
+    }
+    new_length += update.new_points_y.size();
+    uint64_t points_update_offset = new_length - update.new_points_y.size();
+    if (points_update_offset == 0) {
+        plot.evicted_count = 0;
+        plot.implicit_x = update.implicit_x;
+        plot.implicit_points = false;
+        reset_block_bounds(plot);
+        plot.tail_bounds.reset();
+        plot.x_order.reset();
+    }
+
+    uint64_t bounds_update_offset = points_update_offset;
+    if (update.bounded_length > 0 && !plot.points_x.is_encoded() && !plot.points_y.is_encoded()) { // encoded values are bounded after rounding
+        grow_bounding_box(plot.bb, update.bounding_box);
+        bounds_update_offset += update.bounded_length;
+    }
+
+    if (update.contains_points) {
+        assert(update.new_points_x.size() == update.new_points_y.size());
+        if (points_update_offset == 0 && !plot.points_x.is_encoded() && !update.new_points_x.is_encoded() &&
+            detect_implicit_x(update.new_points_x, plot.implicit_x)) {
+            plot.implicit_points = true;
+            plot.points_x.deallocate();
+        }
+        else if (plot.implicit_points && !continues_implicit_x(plot, update.new_points_x, points_update_offset)) {
+            make_x_explicit(plot);
+        }
+        if (!plot.implicit_points) {
+            merge_values(plot.points_x, update.new_points_x, points_update_offset);
+        }
+    }
+    else {
+        assert(update.new_points_x.size() == 0);
+        if (points_update_offset == 0) {
+            plot.points_x.deallocate();
+        }
+    }
+    merge_values(plot.points_y, update.new_points_y, points_update_offset);
+
+    if (bounds_update_offset < new_length) {
+        grow_bounding_box(plot.bb, bounding_box_of_plot(plot, bounds_update_offset));
+    }
+    if (!update.contains_points || plot.implicit_points) {
+        bound_implicit_x(plot);
+    }
+}
+
+// Moves everything the producer had pushed into the append ring when the staged updates were taken into the plot.
+// The ring is lock-free, so this doesn't need any lock.
+static void drain_append_ring(Plot_IDX plot_idx, uint64_t ring_discard_until, bool was_cleared)
+{
+    Append_Ring& ring = *gps_update.plot_updates[plot_idx].append_ring.load(std::memory_order_acquire);
+    Plot& plot = gps.plots[plot_idx];
+    if (was_cleared) {
+        ring.consumer_drained_since_clear = false;
+    }
+
+    uint64_t head = ring.consumer_drain_until;
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    if (ring_discard_until > tail) {
+        tail = ring_discard_until;
+    }
+    assert(tail <= head);
+
+    uint64_t dropped_count = ring.dropped_count.load(std::memory_order_relaxed);
+    if (dropped_count != ring.consumer_reported_dropped_count) {
+        printf(WARNING "The append ring of the Plot with index '%d' was full, %llu values were dropped.\n",
+               plot_idx, (unsigned long long) (dropped_count - ring.consumer_reported_dropped_count));
+        ring.consumer_reported_dropped_count = dropped_count;
+    }
+
+    if (head == tail) {
+        ring.tail.store(head, std::memory_order_release);
+        ring.kind_reset_at.store(ring.consumer_drained_since_clear ? Append_Ring::NOT_RESET : head, std::memory_order_release);
+        return;
+    }
+
+    bool ring_holds_points = ring.kind.load(std::memory_order_relaxed) == Append_Ring::POINTS;
+    if (plot.implicit_points && ring_holds_points) {
+        make_x_explicit(plot);
+    }
+    if (!plot.empty() && plot.has_x_coordinate() != ring_holds_points) {
+        printf(ERROR "The Plot with index '%d' contains %s and cannot be appended with the %s from its append ring.\n", plot_idx,
+               ring_holds_points ? "numbers" : "points", ring_holds_points ? "points" : "numbers");
+        ring.tail.store(head, std::memory_order_release);
+        ring.kind_reset_at.store(ring.consumer_drained_since_clear ? Append_Ring::NOT_RESET : head, std::memory_order_release);
+        return;
+    }
+
+    uint64_t old_length = plot.points_y.size();
+    if (old_length == 0) {
+        plot.bb.x_begin = MAX_PLOTRANGE_VALUE;
+        plot.bb.x_end = -MAX_PLOTRANGE_VALUE;
+        plot.bb.y_begin = MAX_PLOTRANGE_VALUE;
+        plot.bb.y_end = -MAX_PLOTRANGE_VALUE;
+    }
+    uint64_t new_length = old_length + (head - tail);
+
+    if (ring_holds_points) {
+        plot.points_x.resize(new_length);
+    }
+    plot.points_y.resize(new_length);
+
+    // At most two contiguous runs of slots, before and after the end of the ring.
+    for (uint64_t i = old_length; i < new_length;) {
+        uint64_t slot = tail & ring.mask;
+        uint64_t run = std::min(new_length - i, ring.capacity - slot);
+        const Point* points = &ring.slots[slot];
+        if (ring_holds_points) {
+            plot.points_x.write(i, &points[0].x, 2, run);
+        }
+        plot.points_y.write(i, &points[0].y, 2, run);
+        tail += run;
+        i += run;
+    }
+    ring.tail.store(head, std::memory_order_release);
+    ring.consumer_drained_since_clear = true;
+    ring.kind_reset_at.store(Append_Ring::NOT_RESET, std::memory_order_release);
+
+    grow_bounding_box(plot.bb, bounding_box_of_plot(plot, old_length));
+    if (!ring_holds_points) {
+        bound_implicit_x(plot);
+    }
+}
+
+// Reads everything the other process has written into the shared-memory ring since the last frame directly into the plot.
+static void drain_shm_ring(Plot_IDX plot_idx)
+{
+    Plot& plot = gps.plots[plot_idx];
+    Shm_Ring& ring = *plot.shm_ring;
+
+    uint64_t write_cursor = ring.load_write_cursor();
+    if (write_cursor < ring.read_cursor) {
+        ring.read_cursor = 0; // the writer started over
+    }
+    // The writer may already be writing the slot of sample 'write_cursor', which held the sample 'write_cursor - capacity'.
+    uint64_t readable = ring.capacity - 1;
+    uint64_t begin = ring.read_cursor;
+    if (write_cursor - begin > readable) {
+        ring.dropped_count.fetch_add(write_cursor - readable - begin, std::memory_order_relaxed);
+        begin = write_cursor - readable;
+    }
+    if (begin == write_cursor) return;
+
+    bool ring_holds_points = ring.values_per_slot == 2;
+    if (plot.implicit_points && ring_holds_points) {
+        make_x_explicit(plot);
+    }
+    if (!plot.empty() && plot.has_x_coordinate() != ring_holds_points) {
+        printf(ERROR "The Plot with index '%d' contains %s and cannot be appended with the %s from its shared-memory ring.\n", plot_idx,
+               ring_holds_points ? "numbers" : "points", ring_holds_points ? "points" : "numbers");
+        ring.read_cursor = write_cursor;
+        return;
+    }
+
+    uint64_t old_length = plot.points_y.size();
+    uint64_t count = write_cursor - begin;
+    if (ring_holds_points) {
+        plot.points_x.resize(old_length + count);
+    }
+    plot.points_y.resize(old_length + count);
+
+    // At most two contiguous runs, before and after the end of the data region.
+    for (uint64_t copied = 0; copied < count;) {
+        uint64_t slot = (begin + copied) % ring.capacity;
+        uint64_t run = std::min(count - copied, ring.capacity - slot);
+        uint64_t slot_size = ring.values_per_slot * ring.sample_size;
+        const uint8_t* samples = ring.data + slot * slot_size;
+        if (ring_holds_points) {
+            write_samples(plot.points_x, old_length + copied, samples, ring.sample_type, slot_size, run);
+            write_samples(plot.points_y, old_length + copied, samples + ring.sample_size, ring.sample_type, slot_size, run);
+        }
+        else {
+            write_samples(plot.points_y, old_length + copied, samples, ring.sample_type, slot_size, run);
+        }
+        copied += run;
+    }
+
+    // The writer may have overwritten the oldest of these samples while they were copied, they are dropped.
+    uint64_t cursor_after_copy = ring.load_write_cursor();
+    uint64_t overwritten_until = cursor_after_copy > readable ? cursor_after_copy - readable : 0;
+    if (overwritten_until > begin) {
+        uint64_t torn_count = std::min(overwritten_until - begin, count);
+        if (ring_holds_points) {
+            plot.points_x.erase(old_length, torn_count);
+        }
+        plot.points_y.erase(old_length, torn_count);
+        ring.dropped_count.fetch_add(torn_count, std::memory_order_relaxed);
+    }
+    ring.read_cursor = write_cursor;
+
+    if (plot.points_y.size() == old_length) return;
+    Range_XY bb = bounding_box_of_plot(plot, old_length);
+    if (old_length == 0) {
+        plot.bb = bb;
+    }
+    else {
+        grow_bounding_box(plot.bb, bb);
+    }
+}
+
+static Point point_of_plot(Plot& plot, uint64_t i)
+{
+    double scratch[1];
+    double y = *plot.points_y.read(i, 1, scratch);
+    double x = plot.has_x_coordinate() ? *plot.points_x.read(i, 1, scratch) : plot.implicit_x_of(i);
+    return Point{ x, y };
+}
+
+static void push_tail_value(std::deque<Tail_Bounds::Entry>& deque, uint64_t idx, double value, bool is_max)
+{
+    if (value != value) return; // NaN, like the bounding boxes ignore it
+    while (!deque.empty() && (is_max ? deque.back().value <= value : deque.back().value >= value)) {
+        deque.pop_back();
+    }
+    deque.push_back(Tail_Bounds::Entry{ idx, value });
+}
+
+// The bounding box of the last 'n_points' values. Only the values appended since the last call are pushed into the tail
+// bounds, so this doesn't depend on 'n_points' except when the tail bounds are built for a new 'n_points'.
+static Range_XY bounding_box_of_tail(Plot& plot, uint64_t n_points)
+{
+    Tail_Bounds& tail = plot.tail_bounds;
+    uint64_t end = plot.evicted_count + plot.points_y.size();
+    uint64_t begin = end - std::min<uint64_t>(n_points, plot.points_y.size());
+    if (tail.window != n_points) {
+        tail.reset();
+        tail.window = n_points;
+    }
+
+    bool has_x_coordinate = plot.has_x_coordinate();
+    double scratch[READ_BLOCK_LENGTH];
+    for (tail.tracked_until = std::max(tail.tracked_until, begin); tail.tracked_until < end;) {
+        uint64_t i = tail.tracked_until - plot.evicted_count;
+        uint64_t count = std::min<uint64_t>(READ_BLOCK_LENGTH, end - tail.tracked_until);
+        const double* points_y = plot.points_y.read(i, count, scratch);
+        for (uint64_t k = 0; k < count; ++k) {
+            push_tail_value(tail.y_min, tail.tracked_until + k, points_y[k], false);
+            push_tail_value(tail.y_max, tail.tracked_until + k, points_y[k], true);
+        }
+        if (has_x_coordinate) {
+            const double* points_x = plot.points_x.read(i, count, scratch);
+            for (uint64_t k = 0; k < count; ++k) {
+                push_tail_value(tail.x_min, tail.tracked_until + k, points_x[k], false);
+                push_tail_value(tail.x_max, tail.tracked_until + k, points_x[k], true);
+            }
+        }
+        tail.tracked_until += count;
+    }
+
+    std::deque<Tail_Bounds::Entry>* deques[4] = { &tail.y_min, &tail.y_max, &tail.x_min, &tail.x_max };
+    for (std::deque<Tail_Bounds::Entry>* deque : deques) {
+        while (!deque->empty() && deque->front().idx < begin) deque->pop_front();
+    }
+
+    Range_XY bb = { MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE };
+    if (begin == end) return bb;
+    if (!tail.y_min.empty()) {
+        bb.y_begin = tail.y_min.front().value;
+        bb.y_end = tail.y_max.front().value;
+    }
+    if (!has_x_coordinate) {
+        bb.x_begin = plot.implicit_x_of(begin - plot.evicted_count);
+        bb.x_end = plot.implicit_x_of(end - 1 - plot.evicted_count);
+    }
+    else if (!tail.x_min.empty()) {
+        bb.x_begin = tail.x_min.front().value;
+        bb.x_end = tail.x_max.front().value;
+    }
+    return bb;
+}
+
+// The node of the min/max tree, level 0 are the block bounds.
+static const Range_XY& bounds_of_node(Plot& plot, uint64_t level, uint64_t node)
+{
+    if (level == 0) return plot.block_bounds[node - plot.first_block].bb;
+    Bounds_Level& bounds_level = plot.bounds_tree[level - 1];
+    return bounds_level.nodes[node - bounds_level.first];
+}
+
+// Drops the nodes of evicted blocks and bounds the nodes above the blocks [changed_begin, changed_end) again.
+static void update_bounds_tree(Plot& plot, uint64_t changed_begin, uint64_t changed_end)
+{
+    uint64_t first = plot.first_block;
+    uint64_t last = plot.first_block + plot.block_bounds.size() - 1;
+    uint64_t level = 1;
+    for (; (first >> (level - 1)) < (last >> (level - 1)); ++level) {
+        if (plot.bounds_tree.size() < level) {
+            plot.bounds_tree.emplace_back();
+        }
+        Bounds_Level& bounds_level = plot.bounds_tree[level - 1];
+        uint64_t level_first = first >> level;
+        uint64_t level_last = last >> level;
+        uint64_t dropped = std::min<uint64_t>(level_first - bounds_level.first, bounds_level.nodes.size());
+        bounds_level.nodes.erase(bounds_level.nodes.begin(), bounds_level.nodes.begin() + dropped);
+        bounds_level.first = level_first;
+        uint64_t kept = bounds_level.nodes.size();
+        bounds_level.nodes.resize(level_last - level_first + 1);
+
+        uint64_t node_begin = std::max(level_first, changed_begin >> level);
+        uint64_t node_end = std::min(level_last, (changed_end - 1) >> level) + 1;
+        if (level_first + kept <= level_last) { // the new nodes are bounded as well
+            node_begin = std::min(node_begin, level_first + kept);
+            node_end = level_last + 1;
+        }
+        for (uint64_t node = node_begin; node < node_end; ++node) {
+            Range_XY bb = { MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE };
+            for (uint64_t child = std::max(2 * node, first >> (level - 1)); child <= std::min(2 * node + 1, last >> (level - 1)); ++child) {
+                grow_bounding_box(bb, bounds_of_node(plot, level - 1, child));
+            }
+            bounds_level.nodes[node - level_first] = bb;
+        }
+    }
+    plot.bounds_tree.resize(level - 1);
+}
+
+// Brings the block bounds up to date after values were appended or evicted, the plot's bounding box is then computed from them.
+static void update_block_bounds(Plot& plot, bool evicted)
+{
+    uint64_t begin = plot.evicted_count;
+    uint64_t end = plot.evicted_count + plot.points_y.size();
+
+    uint64_t first_block = begin / BOUNDS_BLOCK_LENGTH;
+    uint64_t appended_block = std::max(plot.bounded_until / BOUNDS_BLOCK_LENGTH, first_block);
+    uint64_t evicted_blocks = std::min<uint64_t>(first_block - plot.first_block, plot.block_bounds.size());
+    plot.block_bounds.erase(plot.block_bounds.begin(), plot.block_bounds.begin() + evicted_blocks);
+    plot.first_block = first_block;
+    if (plot.block_bounds.empty() || plot.bounded_until <= begin) { // no bounded value is left
+        plot.block_bounds.clear();
+        plot.bounds_tree.clear();
+        plot.bounded_until = begin;
+    }
+    else if (evicted) {
+        // Only some values of the first block were evicted, it is bounded again.
+        uint64_t first_block_end = std::min((first_block + 1) * BOUNDS_BLOCK_LENGTH, plot.bounded_until);
+        plot.block_bounds[0].bb = bounding_box_of_values(plot, 0, first_block_end - begin);
+        plot.block_bounds[0].first = point_of_plot(plot, 0);
+    }
+
+    // Many appended blocks, like those of a large fill, are bounded on more threads first. The blocks appended per frame
+    // are bounded one after the other below, without allocating.
+    uint64_t bounded_block = plot.bounded_until / BOUNDS_BLOCK_LENGTH;
+    std::vector<Range_XY> bbs;
+    uint64_t thread_count = bounds_thread_count(plot, end - plot.bounded_until);
+    if (thread_count > 1) {
+        bbs.resize((end - 1) / BOUNDS_BLOCK_LENGTH - bounded_block + 1);
+        bound_on_threads(thread_count, [&](uint64_t i) {
+            for (uint64_t j = bbs.size() * i / thread_count; j < bbs.size() * (i + 1) / thread_count; ++j) {
+                uint64_t block_begin = std::max((bounded_block + j) * BOUNDS_BLOCK_LENGTH, plot.bounded_until);
+                uint64_t block_end = std::min((bounded_block + j + 1) * BOUNDS_BLOCK_LENGTH, end);
+                bbs[j] = bounding_box_of_chunk(plot, block_begin - begin, block_end - begin);
+            }
+        });
+    }
+
+    for (uint64_t block_begin = plot.bounded_until; block_begin < end;) {
+        uint64_t block = block_begin / BOUNDS_BLOCK_LENGTH;
+        uint64_t block_end = std::min((block + 1) * BOUNDS_BLOCK_LENGTH, end);
+        Range_XY bb = bbs.empty() ? bounding_box_of_chunk(plot, block_begin - begin, block_end - begin) : bbs[block - bounded_block];
+        if (block - first_block < plot.block_bounds.size()) {
+            grow_bounding_box(plot.block_bounds[block - first_block].bb, bb);
+        }
+        else {
+            plot.block_bounds.push_back(Block_Bounds{ bb, point_of_plot(plot, block_begin - begin), Point{} });
+        }
+        plot.block_bounds[block - first_block].last = point_of_plot(plot, block_end - 1 - begin);
+        block_begin = block_end;
+    }
+    plot.bounded_until = end;
+
+    plot.bb = Range_XY{ MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE };
+    if (plot.block_bounds.empty()) {
+        plot.bounds_tree.clear();
+    }
+    else {
+        if (evicted) {
+            update_bounds_tree(plot, first_block, first_block + 1);
+        }
+        update_bounds_tree(plot, appended_block, first_block + plot.block_bounds.size());
+        plot.bb = bounds_of_node(plot, plot.bounds_tree.size(), first_block >> plot.bounds_tree.size());
+    }
+    if (!plot.has_x_coordinate()) {
+        bound_implicit_x(plot);
+    }
+}
+
+// The bounding box of the values [begin_idx, end_idx), the whole blocks in between are bounded by O(log n) nodes of the
+// min/max tree.
+static Range_XY bounding_box_of_range(Plot& plot, uint64_t begin_idx, uint64_t end_idx)
+{
+    if (plot.bounded_until != plot.evicted_count + plot.points_y.size()) {
+        update_block_bounds(plot, false); // the bounds of contiguous plots are only kept once they are queried
+    }
+    uint64_t block_begin = (plot.evicted_count + begin_idx + BOUNDS_BLOCK_LENGTH - 1) / BOUNDS_BLOCK_LENGTH;
+    uint64_t block_end = (plot.evicted_count + end_idx) / BOUNDS_BLOCK_LENGTH;
+    if (block_begin >= block_end) {
+        return bounding_box_of_values(plot, begin_idx, end_idx);
+    }
+
+    Range_XY bb = { MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE };
+    uint64_t head_end = block_begin * BOUNDS_BLOCK_LENGTH - plot.evicted_count;
+    uint64_t tail_begin = block_end * BOUNDS_BLOCK_LENGTH - plot.evicted_count;
+    if (begin_idx < head_end) {
+        grow_bounding_box(bb, bounding_box_of_values(plot, begin_idx, head_end));
+    }
+    if (tail_begin < end_idx) {
+        grow_bounding_box(bb, bounding_box_of_values(plot, tail_begin, end_idx));
+    }
+    for (uint64_t level = 0; block_begin < block_end; ++level) {
+        if (block_begin & 1) grow_bounding_box(bb, bounds_of_node(plot, level, block_begin++));
+        if (block_end & 1) grow_bounding_box(bb, bounds_of_node(plot, level, --block_end));
+        block_begin >>= 1;
+        block_end >>= 1;
+    }
+    return bb;
+}
+
+// Finds the indices within [begin_idx, end_idx) at which the values cross 'level', where a value lies on the other side of
+// it than the value before (NaNs are skipped). The nodes of the min/max tree which lie on one side are skipped entirely.
+static uint64_t find_threshold_crossings(Plot& plot, double level, uint64_t begin_idx, uint64_t end_idx, uint64_t* crossings, uint64_t max_crossings)
+{
+    if (plot.bounded_until != plot.evicted_count + plot.points_y.size()) {
+        update_block_bounds(plot, false);
+    }
+    Sample_Reader points_y(plot.points_y);
+    uint64_t count = 0;
+    int side = -1; // 0 below the level, 1 at or above it and -1 before the first value
+    auto visit = [&](uint64_t i) {
+        double y = points_y[i];
+        if (y != y) return false;
+        int value_side = y >= level;
+        if (side >= 0 && value_side != side) {
+            crossings[count++] = i;
+        }
+        side = value_side;
+        return true;
+    };
+
+    uint64_t block_end = (plot.evicted_count + end_idx) / BOUNDS_BLOCK_LENGTH; // the blocks before it are whole
+    for (uint64_t i = begin_idx; i < end_idx && count < max_crossings;) {
+        uint64_t block = (plot.evicted_count + i) / BOUNDS_BLOCK_LENGTH;
+        if ((plot.evicted_count + i) % BOUNDS_BLOCK_LENGTH != 0 || block >= block_end) {
+            visit(i++);
+            continue;
+        }
+
+        // The largest node starting at this block, its side is either known from its bounds or it is searched below.
+        uint64_t node_level = 0;
+        while (node_level < plot.bounds_tree.size() && block % (2ull << node_level) == 0 && block + (2ull << node_level) <= block_end) {
+            ++node_level;
+        }
+        for (;; --node_level) {
+            const Range_XY& bb = bounds_of_node(plot, node_level, block >> node_level);
+            uint64_t node_end = i + (BOUNDS_BLOCK_LENGTH << node_level);
+            if (bb.y_begin > bb.y_end) { // only NaNs
+                i = node_end;
+                break;
+            }
+            int node_side = bb.y_begin >= level ? 1 : bb.y_end < level ? 0 : -1;
+            if (node_side >= 0) {
+                if (side >= 0 && node_side != side) {
+                    while (!visit(i)) ++i; // the crossing is at its first value
+                }
+                side = node_side;
+                i = node_end;
+                break;
+            }
+            if (node_level == 0) {
+                for (; i < node_end && count < max_crossings; ++i) {
+                    visit(i);
+                }
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+// Checks the x values appended since the last call, a plot stays non-monotonic until its values are replaced.
+static bool x_is_monotonic(Plot& plot)
+{
+    X_Order& x_order = plot.x_order;
+    if (x_order.checked_until < plot.evicted_count) {
+        x_order.checked_until = plot.evicted_count;
+    }
+    uint64_t length = plot.points_x.size();
+    double scratch[READ_BLOCK_LENGTH];
+    for (uint64_t begin = x_order.checked_until - plot.evicted_count; x_order.monotonic && begin < length; begin += READ_BLOCK_LENGTH) {
+        uint64_t count = std::min<uint64_t>(READ_BLOCK_LENGTH, length - begin);
+        const double* points_x = plot.points_x.read(begin, count, scratch);
+        for (uint64_t i = 0; i < count; ++i) {
+            if (!(points_x[i] >= x_order.last)) {
+                x_order.monotonic = false;
+                break;
+            }
+            x_order.last = points_x[i];
+        }
+    }
+    x_order.checked_until = plot.evicted_count + length;
+    return x_order.monotonic;
+}
+
+// The first index whose x value is at least 'x', or 0 if the x values of the plot aren't monotonic.
+static uint64_t first_index_at_x(Plot& plot, double x)
+{
+    uint64_t length = plot.points_y.size();
+    if (!plot.has_x_coordinate()) {
+        if (!(plot.implicit_x.dx > 0)) return 0;
+        double idx = std::ceil(plot.implicit_index_of(x));
+        return idx <= 0 ? 0 : idx >= length ? length : (uint64_t) idx;
+    }
+    if (!x_is_monotonic(plot)) return 0;
+    Sample_Reader points_x(plot.points_x);
+    uint64_t low = 0, high = length;
+    while (low < high) {
+        uint64_t mid = low + (high - low) / 2;
+        if (points_x[mid] < x) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+// The bounding box of the values from 'x_begin' on, plots whose x values aren't monotonic are bounded as a whole.
+static Range_XY bounding_box_of_x_tail(Plot& plot, double x_begin)
+{
+    uint64_t begin_idx = first_index_at_x(plot, x_begin);
+    if (begin_idx == 0) return plot.bb;
+    if (begin_idx == plot.points_y.size()) {
+        return Range_XY{ MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE };
+    }
+    return bounding_box_of_range(plot, begin_idx, plot.points_y.size());
+}
+
+static void evict_oldest_values(Plot& plot, uint64_t count)
+{
+    if (plot.has_x_coordinate()) {
+        plot.points_x.erase_front(count);
+    }
+    plot.points_y.erase_front(count);
+    plot.evicted_count += count;
+}
+
+// Evicts the values which are beyond the plot's retention.
+static void apply_retention(Plot& plot)
+{
+    uint64_t length = plot.points_y.size();
+    bool has_x_coordinate = plot.has_x_coordinate();
+
+    uint64_t evict_count = 0;
+    if (plot.retention.max_count > 0 && length > plot.retention.max_count) {
+        evict_count = length - plot.retention.max_count;
+    }
+    if (plot.retention.x_range > 0 && length > 0) {
+        if (has_x_coordinate) {
+            // The oldest points are evicted up to the first one within the range, also if later ones are outside of it.
+            Sample_Reader points_x(plot.points_x);
+            double min_x = points_x[length - 1] - plot.retention.x_range;
+            while (min_x == min_x && evict_count < length - 1 && !(points_x[evict_count] >= min_x)) ++evict_count;
+        }
+        else if (plot.retention.x_range / plot.implicit_x.dx < length - 1) {
+            evict_count = std::max(evict_count, length - 1 - (uint64_t) (plot.retention.x_range / plot.implicit_x.dx));
+        }
+    }
+
+    if (evict_count > 0) {
+        evict_oldest_values(plot, evict_count);
+    }
+    if (evict_count > 0 || plot.bounded_until != plot.evicted_count + plot.points_y.size()) {
+        update_block_bounds(plot, evict_count > 0);
+    }
+}
+
+// Compresses the chunks of the plot which are no longer appended to, until 'compressed_count' reaches the maximum per frame.
+// Returns whether no chunk is left to compress.
+static bool compress_chunks_of_plot(Plot_IDX plot_idx, uint64_t& compressed_count, uint64_t* words)
+{
+    if (!gps.plots[plot_idx].compressed) return true;
+    Sample_Buffer* buffers[2] = { &gps.plots[plot_idx].points_x, &gps.plots[plot_idx].points_y };
+    for (Sample_Buffer* buffer : buffers) {
+        if (!buffer->can_compress()) continue;
+        for (uint64_t i = buffer->spilled_count; i + 1 < buffer->chunks.size(); ++i) {
+            if (buffer->chunks[i].compressed || buffer->chunks[i].incompressible) continue;
+            if (compressed_count == MAX_COMPRESSED_CHUNKS_PER_FRAME) return false;
+            buffer->compress(i, words);
+            gps.compacted_plots.push_back(plot_idx);
+            ++compressed_count;
+        }
+    }
+    return true;
+}
+
+// Compresses the chunks which are no longer appended to, only a few per frame so no frame takes much longer. Only the
+// plots which were appended to are queued, the others have nothing new to compress.
+static void compress_plots()
+{
+    std::vector<Plot_IDX>* appended_plots[] = { &gps.taken_plots, &gps.append_ring_plots, &gps.shm_ring_plots };
+    for (std::vector<Plot_IDX>* plots : appended_plots) {
+        for (size_t i = 0; i < plots->size(); ++i) {
+            Plot& plot = gps.plots[(*plots)[i]];
+            if (plot.compressed && !plot.queued_for_compression) {
+                plot.queued_for_compression = true;
+                gps.compression_queue.push_back((*plots)[i]);
+            }
+        }
+    }
+
+    static std::vector<uint64_t> words(MAX_COMPRESSED_WORDS);
+    uint64_t compressed_count = 0;
+    size_t done_count = 0;
+    while (done_count < gps.compression_queue.size() &&
+           compress_chunks_of_plot(gps.compression_queue[done_count], compressed_count, words.data())) {
+        gps.plots[gps.compression_queue[done_count]].queued_for_compression = false;
+        ++done_count;
+    }
+    gps.compression_queue.erase(gps.compression_queue.begin(), gps.compression_queue.begin() + done_count);
+}
+
+// Spills the oldest chunks of the largest plots until the storage which is kept in memory fits into the spill limit.
+static void spill_plots()
+{
+    if (gps.spill_limit.max_resident_bytes == 0) return;
+
+    uint64_t resident_size = 0;
+    for (Plot_IDX plot_idx = gps.plots.first(); plot_idx < gps.plots.end(); plot_idx = gps.plots.next(plot_idx)) {
+        resident_size += gps.plots[plot_idx].points_x.resident_size() + gps.plots[plot_idx].points_y.resident_size();
+    }
+    while (resident_size > gps.spill_limit.max_resident_bytes) {
+        Sample_Buffer* largest = nullptr;
+        Plot_IDX largest_plot_idx = 0;
+        for (Plot_IDX plot_idx = gps.plots.first(); plot_idx < gps.plots.end(); plot_idx = gps.plots.next(plot_idx)) {
+            Sample_Buffer* buffers[2] = { &gps.plots[plot_idx].points_x, &gps.plots[plot_idx].points_y };
+            for (Sample_Buffer* buffer : buffers) {
+                if (buffer->can_spill() && (!largest || buffer->resident_size() > largest->resident_size())) {
+                    largest = buffer;
+                    largest_plot_idx = plot_idx;
+                }
+            }
+        }
+        if (!largest) return; // the rest is the contiguous values and the newest chunk of every plot
+        if (!largest->spill_chunk(gps.spill_limit.directory.c_str())) {
+            printf(ERROR "Spilling plots is disabled.\n");
+            gps.spill_limit.max_resident_bytes = 0;
+            gps_update_mutex.lock();
+            gps_update.spill_limit.max_resident_bytes = 0;
+            gps_update_mutex.unlock();
+            return;
+        }
+        gps.compacted_plots.push_back(largest_plot_idx);
+        resident_size -= largest->chunk_size();
+    }
+}
+
+static uint64_t capacity_of_plot(Plot& plot)
+{
+    return plot.points_x.resident_size() + plot.points_y.resident_size() + plot.block_bounds.capacity() * sizeof(Block_Bounds);
+}
+
+static uint64_t taken_capacity_of_plot(Plot_IDX plot_idx)
+{
+    Plot_Update& taken = gps.taken_plot_updates[plot_idx];
+    return taken.new_points_x.memory_size() + taken.new_points_y.memory_size();
+}
+
+static uint64_t memory_size_of_plots()
+{
+    uint64_t memory_size = 0;
+    for (Plot_IDX plot_idx = gps.plots.first(); plot_idx < gps.plots.end(); plot_idx = gps.plots.next(plot_idx)) {
+        memory_size += capacity_of_plot(gps.plots[plot_idx]) + taken_capacity_of_plot(plot_idx);
+    }
+    return memory_size;
+}
+
+// Evicts the oldest values of the plot until it holds 'min_freed_bytes' less, or nothing at all. Plots without a retention
+// only keep block bounds once their values are in chunks, the others are bounded again from scratch.
+static void trim_plot(Plot& plot, uint64_t min_freed_bytes)
+{
+    uint64_t length = plot.points_y.size();
+    uint64_t value_size = plot.points_y.sample_size + (plot.has_x_coordinate() ? plot.points_x.sample_size : 0);
+    uint64_t evict_count = std::min(length, std::max<uint64_t>(CHUNK_LENGTH, (min_freed_bytes + value_size - 1) / value_size));
+    evict_oldest_values(plot, evict_count);
+    plot.points_x.shrink_to_fit();
+    plot.points_y.shrink_to_fit();
+
+    if (plot.retention.bounded() || !plot.points_y.chunks.empty() || !plot.block_bounds.empty()) {
+        update_block_bounds(plot, true);
+    }
+    else {
+        reset_block_bounds(plot);
+        plot.block_bounds.shrink_to_fit();
+        plot.bb = Range_XY{ MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE };
+        if (!plot.points_y.empty()) {
+            plot.bb = bounding_box_of_plot(plot, 0);
+        }
+    }
+}
+
+// Frees the unused capacity once the plots exceed the memory limit, and with PLOTLIB_MEMORY_TRIM_LARGEST then evicts the
+// oldest values of the largest plot until they fit. Values staged by the api functions aren't seen here, the staging limit
+// bounds them instead. Returns whether the limit was exceeded, then the memory of any plot may have changed.
+static bool apply_memory_limit()
+{
+    Memory_Limit limit = gps.memory_limit;
+    if (limit.max_bytes == 0) return false;
+
+    uint64_t memory_size = memory_size_of_plots();
+    if (memory_size <= limit.max_bytes) return false;
+
+    // Buffers are only shrunk if at least half of them is unused, so plots which stay above the limit aren't copied every frame.
+    for (Plot_IDX plot_idx = gps.plots.first(); plot_idx < gps.plots.end(); plot_idx = gps.plots.next(plot_idx)) {
+        Plot& plot = gps.plots[plot_idx];
+        Sample_Buffer* buffers[2] = { &plot.points_x, &plot.points_y };
+        for (Sample_Buffer* buffer : buffers) {
+            if (buffer->mostly_unused()) buffer->shrink_to_fit();
+            else buffer->drop_cache();
+        }
+        if (2 * plot.block_bounds.size() <= plot.block_bounds.capacity()) {
+            plot.block_bounds.shrink_to_fit();
+        }
+        // Staging buffers which the last update mostly used are kept, a steady stream would allocate them again right away.
+        Plot_Update& taken = gps.taken_plot_updates[plot_idx];
+        Sample_Buffer* staged[2] = { &taken.new_points_x, &taken.new_points_y };
+        for (Sample_Buffer* buffer : staged) {
+            if (2 * taken.merged_length <= buffer->allocation_length) buffer->deallocate();
+        }
+        taken.merged_length = 0; // unless the plot is updated again, the buffers are released next time
+    }
+    if (limit.policy != PLOTLIB_MEMORY_TRIM_LARGEST) return true;
+
+    // Only the memory of the values can be trimmed, staging buffers and borrowed values don't count here.
+    uint64_t trimmable_size = 0;
+    for (Plot_IDX plot_idx = gps.plots.first(); plot_idx < gps.plots.end(); plot_idx = gps.plots.next(plot_idx)) {
+        trimmable_size += capacity_of_plot(gps.plots[plot_idx]);
+    }
+    while (trimmable_size > limit.max_bytes) {
+        Plot* largest = nullptr;
+        uint64_t largest_capacity = 0;
+        for (Plot_IDX plot_idx = gps.plots.first(); plot_idx < gps.plots.end(); plot_idx = gps.plots.next(plot_idx)) {
+            Plot& plot = gps.plots[plot_idx];
+            if (!plot.points_y.empty() && capacity_of_plot(plot) > largest_capacity) {
+                largest = &plot;
+                largest_capacity = capacity_of_plot(plot);
+            }
+        }
+        if (!largest) break;
+        trim_plot(*largest, trimmable_size - limit.max_bytes);
+        uint64_t new_capacity = capacity_of_plot(*largest);
+        if (new_capacity >= largest_capacity) break; // nothing was freed, the other plots would be emptied for nothing
+        trimmable_size -= largest_capacity - new_capacity;
+    }
+    return true;
+}
+
+// Publishes the memory of the plot for 'plot_get_memory_usage'.
+static void publish_memory_usage_of(Plot_IDX plot_idx)
+{
+    Plot& plot = gps.plots[plot_idx];
+    Plot_Memory& plot_memory = gps_update.plot_memory[plot_idx];
+    plot_memory.live_bytes.store(plot.points_x.live_size() + plot.points_y.live_size(), std::memory_order_relaxed);
+    plot_memory.capacity_bytes.store(capacity_of_plot(plot), std::memory_order_relaxed);
+    plot_memory.taken_bytes.store(taken_capacity_of_plot(plot_idx), std::memory_order_relaxed);
+}
+
+// Only the memory of the plots which changed this frame is published again, unless the memory limit changed any plot.
+static void publish_memory_usage(bool all_plots)
+{
+    if (all_plots) {
+        for (Plot_IDX plot_idx = gps.plots.first(); plot_idx < gps.plots.end(); plot_idx = gps.plots.next(plot_idx)) {
+            publish_memory_usage_of(plot_idx);
+        }
+    }
+    else {
+        std::vector<Plot_IDX>* changed_plots[] = { &gps.taken_plots, &gps.append_ring_plots, &gps.shm_ring_plots,
+                                                   &gps.retention_plots, &gps.compacted_plots };
+        for (std::vector<Plot_IDX>* plots : changed_plots) {
+            for (size_t i = 0; i < plots->size(); ++i) {
+                publish_memory_usage_of((*plots)[i]);
+            }
+        }
+    }
+    gps.compacted_plots.clear();
+}
+
+static void merge_plot_group_update(Group_IDX group_idx, Plot_Group_Update& update)
+{
+    Plot_Group& group = gps.plot_groups[group_idx];
+
+    if (!group.initialized) {
+        int label_len = 24; // should be enough for "[group_idx]"
+        group.label = new char[label_len];
+        snprintf(group.label, label_len, "[%d] Plot Group", group_idx);
+        group.label[label_len - 1] = '\0';
+        
+        group.initialized = true;
+    }
+
+    if (update.new_name) {
+        int label_len = 12 + strlen(update.new_name) + 1;
+        delete[] group.label;
+        group.label = new char[label_len];
+        snprintf(group.label, label_len, "[%d] %s", group_idx, update.new_name);
+        group.label[label_len - 1] = '\0';
+    }
+
+    if (update.was_cleared) {
+        group.plots.clear();
+    }
+
+    for (size_t i = 0; i < update.new_plots.size(); ++i) {
+        bool already_contained = false;
+        for (size_t j = 0; j < group.plots.size(); ++j) {
+            already_contained |= group.plots[j] == update.new_plots[i];
+        }
+        if (!already_contained) {
+            group.plots.push_back(update.new_plots[i]);
+        }
+    }
+
+    for (size_t i = 0; i < update.remove_plots.size(); ++i) {
+        for (size_t j = 0; j < group.plots.size(); ++j) {
+            if (group.plots[j] == update.remove_plots[i]) {
+                group.plots.erase(group.plots.begin() + j);
+            }
+        }
+    }
+}
+
+// Only swaps the staged updates out of 'gps_update' while holding the lock, which takes constant time per touched plot
+// no matter how many points were staged. Copying the points and updating the bounding boxes happens after unlocking.
+static void apply_and_reset_gps_update()
+{
+    gps_update_mutex.lock();
+    
+    gps.visible_group = gps_update.visible_group;
+    gps.window_visible = gps_update.window_visible;
+    if (gps.vis_mode.type == Visualization_Mode::SHOW_N_POINTS_OF_TAIL && gps_update.vis_mode.type != gps.vis_mode.type) {
+        for (Plot_IDX plot_idx = gps.plots.first(); plot_idx < gps.plots.end(); plot_idx = gps.plots.next(plot_idx)) {
+            gps.plots[plot_idx].tail_bounds.reset(); // they are only kept for this mode
+        }
+    }
+    gps.vis_mode = gps_update.vis_mode;
+    gps.spill_limit = gps_update.spill_limit;
+    gps.memory_limit = gps_update.memory_limit;
+    gps.terminate = gps_update.terminate;
+
+    if (!gps.window_visible) {
+        gps_update_mutex.unlock();
+        return;
+    }
+    
+    gps.gui.colors = gps_update.theme_colors;
+
+    assert(gps.taken_plots.empty() && gps.taken_groups.empty());
+    gps.taken_groups.swap(gps_update.dirty_groups);
+
+    // Holding the 'gps_update_mutex' keeps batches from being committed half-way through taking the shards.
+    for (uint32_t shard_idx = 0; shard_idx < PLOT_SHARD_COUNT; ++shard_idx) {
+        Plot_Shard& shard = gps_update.plot_shards[shard_idx];
+        shard.mutex.lock();
+        for (size_t i = 0; i < shard.dirty_plots.size(); ++i) {
+            Plot_IDX plot_idx = shard.dirty_plots[i];
+            gps_update.plot_updates[plot_idx].take_into(gps.taken_plot_updates[plot_idx]);
+            gps.taken_plots.push_back(plot_idx);
+        }
+        shard.dirty_plots.clear();
+        shard.mutex.unlock();
+    }
+
+    for (size_t i = 0; i < gps.taken_groups.size(); ++i) {
+        Group_IDX group_idx = gps.taken_groups[i];
+        gps_update.plot_group_updates[group_idx].take_into(gps.taken_plot_group_updates[group_idx]);
+    }
+
+    for (size_t i = gps.append_ring_plots.size(); i < gps_update.append_ring_plots.size(); ++i) {
+        gps.append_ring_plots.push_back(gps_update.append_ring_plots[i]);
+    }
+    // Batches push into the rings while committing, so what they pushed is drained together with what they staged.
+    for (size_t i = 0; i < gps.append_ring_plots.size(); ++i) {
+        Append_Ring& ring = *gps_update.plot_updates[gps.append_ring_plots[i]].append_ring.load(std::memory_order_acquire);
+        ring.consumer_drain_until = ring.head.load(std::memory_order_acquire);
+    }
+
+    gps_update.terminate = false;
+    
+    gps_update_mutex.unlock();
+    gps_update_taken.notify_all();
+
+    for (size_t i = 0; i < gps.taken_plots.size(); ++i) {
+        Plot_IDX plot_idx = gps.taken_plots[i];
+        merge_plot_update(plot_idx, gps.taken_plot_updates[plot_idx]);
+    }
+
+    for (size_t i = 0; i < gps.append_ring_plots.size(); ++i) {
+        Plot_IDX plot_idx = gps.append_ring_plots[i];
+        drain_append_ring(plot_idx, gps.taken_plot_updates[plot_idx].ring_discard_until, gps.taken_plot_updates[plot_idx].was_cleared);
+    }
+
+    for (size_t i = 0; i < gps.shm_ring_plots.size(); ++i) {
+        drain_shm_ring(gps.shm_ring_plots[i]);
+    }
+
+    for (size_t i = 0; i < gps.retention_plots.size(); ++i) {
+        apply_retention(gps.plots[gps.retention_plots[i]]);
+    }
+
+    // Only the plots which were appended to this frame can have unbounded values, the retention already bounded its plots.
+    std::vector<Plot_IDX>* appended_plots[] = { &gps.taken_plots, &gps.append_ring_plots, &gps.shm_ring_plots };
+    for (std::vector<Plot_IDX>* plots : appended_plots) {
+        for (size_t i = 0; i < plots->size(); ++i) {
+            Plot& plot = gps.plots[(*plots)[i]];
+            if (!plot.retention.bounded() && !plot.points_y.chunks.empty() && plot.bounded_until != plot.evicted_count + plot.points_y.size()) {
+                update_block_bounds(plot, false);
+            }
+        }
+    }
+
+    compress_plots();
+    spill_plots();
+
+    for (size_t i = 0; i < gps.taken_plots.size(); ++i) {
+        gps.taken_plot_updates[gps.taken_plots[i]].reset();
+    }
+
+    bool exceeded_memory_limit = apply_memory_limit();
+    publish_memory_usage(exceeded_memory_limit);
+    gps.taken_plots.clear();
+
+    for (size_t i = 0; i < gps.taken_groups.size(); ++i) {
+        Group_IDX group_idx = gps.taken_groups[i];
+        merge_plot_group_update(group_idx, gps.taken_plot_group_updates[group_idx]);
+        gps.taken_plot_group_updates[group_idx].reset();
+    }
+    gps.taken_groups.clear();
+}
+
+static double linear_map(double x, double in_min, double in_max, double out_min, double out_max) {
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+static void gui_update_plot_range_interactive_mode(Range_XY& plot_range, rl::Rectangle plot_screen)
+{
+    auto x_to_plotspace = [=](double x) -> double {
+        return linear_map(x, (double) plot_screen.x, (double) plot_screen.x + plot_screen.width, plot_range.x_begin, plot_range.x_end);
+    };
+
+    auto y_to_plotspace = [=](double y) -> double {
+        return linear_map(y, (double) plot_screen.y, (double) plot_screen.y + plot_screen.height, plot_range.y_end, plot_range.y_begin);
+    };
+
+    double plot_space_pan_x = 0;
+    double plot_space_pan_y = 0;
+    if (rl::IsMouseButtonDown(rl::MOUSE_LEFT_BUTTON)) {
+        rl::Vector2 mouse_delta = rl::GetMouseDelta();
+        plot_space_pan_x = x_to_plotspace(0) - x_to_plotspace(mouse_delta.x);
+        plot_space_pan_y = y_to_plotspace(0) - y_to_plotspace(mouse_delta.y);
+    }
+
+    float mouse_wheel_delta = rl::GetMouseWheelMove();
+    double zoom_factor_x = std::pow(1.2, (double) -mouse_wheel_delta * SCROLL_ZOOM_FACTOR);
+    double zoom_factor_y = std::pow(1.2, (double) -mouse_wheel_delta * SCROLL_ZOOM_FACTOR);
+
+    if (rl::IsKeyDown(rl::KEY_LEFT_CONTROL)) {
+        zoom_factor_x = 1.0;
+    }
+    
+    if (rl::IsKeyDown(rl::KEY_LEFT_SHIFT)) {
+        zoom_factor_y = 1.0;
+    }
+
+    if (mouse_wheel_delta) {
+        gps.gui.zoom_resize_cooldown = 2;
+    }
+
+    auto x_to_screenspace = [=](double x) -> float {
+        return linear_map(x, plot_range.x_begin, plot_range.x_end, (double) plot_screen.x, (double) plot_screen.x + plot_screen.width);
+    };
+
+    auto y_to_screenspace = [=](double y) -> float {
+        return linear_map(y, plot_range.y_begin, plot_range.y_end, (double) plot_screen.y + plot_screen.height, (double) plot_screen.y);
+    };
+
+    rl::Vector2 mouse_pos = rl::GetMousePosition();
+    double zoom_center_x = x_to_plotspace(mouse_pos.x);
+    double zoom_center_y = y_to_plotspace(mouse_pos.y);
+
+    // prefer zooming to the origin / to the x=0, y=0 coordinate axes
+    if (std::abs(x_to_screenspace(0) - mouse_pos.x) < gps.gui.zoom_to_zero_pixel_distance_threshold) {
+        zoom_center_x = 0;
+    }
+
+    if (std::abs(y_to_screenspace(0) - mouse_pos.y) < gps.gui.zoom_to_zero_pixel_distance_threshold) {
+        zoom_center_y = 0;
+    }
+
+    // xy = zoom_matrix * (xy - mouse_pos) + mouse_pos + mouse_pan
+    plot_range.x_begin = zoom_factor_x * (plot_range.x_begin - zoom_center_x) + zoom_center_x + plot_space_pan_x;
+    plot_range.x_end = zoom_factor_x * (plot_range.x_end - zoom_center_x) + zoom_center_x + plot_space_pan_x;
+    plot_range.y_begin = zoom_factor_y * (plot_range.y_begin - zoom_center_y) + zoom_center_y + plot_space_pan_y;
+    plot_range.y_end = zoom_factor_y * (plot_range.y_end - zoom_center_y) + zoom_center_y + plot_space_pan_y;
+}
+
+struct Ticks {
+    int x_count = 0;
+    int y_count = 0;
+
+    double x_spacing;
+    double x_begin;
+    double y_spacing;
+    double y_begin;
+
+    char x_text[MAX_TICK_MARK_COUNT][MAX_TICK_MARK_TEXT_LENGTH];
+    char y_text[MAX_TICK_MARK_COUNT][MAX_TICK_MARK_TEXT_LENGTH];
+    float x_text_width[MAX_TICK_MARK_COUNT];
+    float x_text_width_max = 0;
+    float y_text_width[MAX_TICK_MARK_COUNT];
+    float y_text_width_max = 0;
+};
+
+// Formats a timestamp (in nanoseconds) as UTC, as precise as the tick spacing needs it.
+static void format_time_tick(char* text, int64_t timestamp, int64_t spacing)
+{
+    int64_t seconds = timestamp / NANOSECONDS_PER_SECOND;
+    int64_t nanoseconds = timestamp % NANOSECONDS_PER_SECOND;
+    if (nanoseconds < 0) {
+        seconds -= 1;
+        nanoseconds += NANOSECONDS_PER_SECOND;
+    }
+    time_t time = (time_t) seconds;
+    std::tm* utc = std::gmtime(&time);
+    if (!utc) {
+        snprintf(text, MAX_TICK_MARK_TEXT_LENGTH, "%lld", (long long) timestamp);
+        return;
+    }
+
+    if (spacing >= (int64_t) SECONDS_PER_DAY * NANOSECONDS_PER_SECOND) {
+        strftime(text, MAX_TICK_MARK_TEXT_LENGTH, "%Y-%m-%d", utc);
+    }
+    else if (spacing >= (int64_t) 60 * NANOSECONDS_PER_SECOND) {
+        strftime(text, MAX_TICK_MARK_TEXT_LENGTH, "%H:%M", utc);
+    }
+    else {
+        size_t length = strftime(text, MAX_TICK_MARK_TEXT_LENGTH, "%H:%M:%S", utc);
+        if (spacing < NANOSECONDS_PER_SECOND) {
+            // As many fractional digits as the spacing has, e.g. 3 for a spacing of 0.25s.
+            int digits = 9;
+            int64_t unit = 1;
+            while (digits > 1 && spacing % (unit * 10) == 0) {
+                unit *= 10;
+                --digits;
+            }
+            snprintf(text + length, MAX_TICK_MARK_TEXT_LENGTH - length, ".%0*lld", digits, (long long) (nanoseconds / unit));
+        }
+    }
+}
+
+static void gui_generate_ticks(Ticks& ticks, rl::Rectangle bounds, Range_XY plot_range, bool x_is_time,
+                               int x_pixels_per_tick = gps.gui.x_pixels_per_tick)
+{
+    auto calculate_tick_spacing = [](double begin, double end, int tick_count) -> double {
+        double raw_step = (end - begin) / tick_count;
+        double exponent = std::floor(std::log10(raw_step));
+        double base = std::pow(10, exponent);
+        double fraction = raw_step / base;
+        const double nice_fractions[] = {1, 2, 2.5, 5, 10};
+        double best_fraction = 1;
+        for (size_t i = 0; i < sizeof(nice_fractions) / sizeof(double); ++i) {
+            if (fraction <= nice_fractions[i]) {
+                best_fraction = nice_fractions[i];
+                break;
+            }
+        }
+        return best_fraction * base;
+    };
+
+    auto remove_excessive_trailing_zeros = [](char* number_str, int max_len){
+        int true_len = strnlen(number_str, max_len);
+        if (true_len <= 0) return;
+
+        int trailing_zeros_cnt = 0;
+        int str_idx = true_len;
+        while (str_idx > 0 && number_str[--str_idx] == '0') ++trailing_zeros_cnt;
+
+        if (trailing_zeros_cnt >= EXCESSIVE_TRAILING_ZEROS_THRESHOLD) {
+            snprintf(&number_str[str_idx + 1], max_len - str_idx, "+e%d", trailing_zeros_cnt);
+        }
+    };
+
+    ticks.x_count = std::min((int) std::floor(bounds.width / x_pixels_per_tick), MAX_TICK_MARK_COUNT);
+    ticks.y_count = std::min((int) std::floor(bounds.height / gps.gui.y_pixels_per_tick), MAX_TICK_MARK_COUNT);
+
+    ticks.x_spacing = calculate_tick_spacing(plot_range.x_begin, plot_range.x_end, ticks.x_count);
+    ticks.x_begin = ceil(plot_range.x_begin / ticks.x_spacing) * ticks.x_spacing;
+
+    // A time axis has its ticks at round times (seconds, minutes, hours, days), computed on the integer timestamps.
+    int64_t origin = time_origin.load(std::memory_order_relaxed);
+    int64_t x_begin_timestamp = 0;
+    int64_t x_spacing_nanoseconds = 0;
+    x_is_time = x_is_time && origin != NO_TIME_ORIGIN && std::abs(plot_range.x_begin) < MAX_TIME_AXIS_SECONDS
+                && std::abs(plot_range.x_end) < MAX_TIME_AXIS_SECONDS;
+    if (x_is_time) {
+        const double nice_seconds[] = { 1, 2, 5, 10, 15, 30, 60, 120, 300, 600, 900, 1800, 3600, 7200, 10800, 21600, 43200, SECONDS_PER_DAY };
+        double raw_step = (plot_range.x_end - plot_range.x_begin) / ticks.x_count;
+        double spacing = ticks.x_spacing;
+        if (raw_step > SECONDS_PER_DAY) {
+            spacing = std::ceil(calculate_tick_spacing(plot_range.x_begin / SECONDS_PER_DAY, plot_range.x_end / SECONDS_PER_DAY, ticks.x_count))
+                      * SECONDS_PER_DAY;
+        }
+        else if (raw_step > 1) {
+            for (size_t i = 0; i < sizeof(nice_seconds) / sizeof(double); ++i) {
+                spacing = nice_seconds[i];
+                if (raw_step <= nice_seconds[i]) break;
+            }
+        }
+        x_spacing_nanoseconds = std::max<int64_t>(1, std::llround(spacing * NANOSECONDS_PER_SECOND));
+        int64_t range_begin = origin + std::llround(plot_range.x_begin * NANOSECONDS_PER_SECOND);
+        x_begin_timestamp = range_begin / x_spacing_nanoseconds * x_spacing_nanoseconds;
+        if (x_begin_timestamp < range_begin) x_begin_timestamp += x_spacing_nanoseconds;
+
+        ticks.x_spacing = (double) x_spacing_nanoseconds / NANOSECONDS_PER_SECOND;
+        ticks.x_begin = (double) (x_begin_timestamp - origin) / NANOSECONDS_PER_SECOND;
+    }
+
+    ticks.y_spacing = calculate_tick_spacing(plot_range.y_begin, plot_range.y_end, ticks.y_count);
+    ticks.y_begin = ceil(plot_range.y_begin / ticks.y_spacing) * ticks.y_spacing;
+
+    int tick_idx = 0;
+    for (double x = ticks.x_begin; x < plot_range.x_end && tick_idx < MAX_TICK_MARK_COUNT; x += ticks.x_spacing, ++tick_idx) {
+        // this is a stupid hack to make sure 0 is dispayed cleanly, it works because 0 is always included as a tick,
+        // if 0 is in the plot_range. So we can find it easily by comparing x to the tick-spacing
+        if (std::abs(x) < ticks.x_spacing * 1e-3) x = 0.0;
+        
+        if (x_is_time) {
+            format_time_tick(ticks.x_text[tick_idx], x_begin_timestamp + tick_idx * x_spacing_nanoseconds, x_spacing_nanoseconds);
+        }
+        else {
+            snprintf(ticks.x_text[tick_idx], MAX_TICK_MARK_TEXT_LENGTH, "%.14g", x);
+            remove_excessive_trailing_zeros(ticks.x_text[tick_idx], MAX_TICK_MARK_TEXT_LENGTH);
+        }
+        ticks.x_text_width[tick_idx] = MeasureTextEx(gps.gui.font_normal, ticks.x_text[tick_idx], gps.gui.fontsize_normal, gps.gui.fontspacing).x;
+        ticks.x_text_width_max = ticks.x_text_width[tick_idx] > ticks.x_text_width_max ? ticks.x_text_width[tick_idx] : ticks.x_text_width_max;
+    }
+
+    // Regenerate the ticks if the text is too wide.
+    if (ticks.x_text_width_max > x_pixels_per_tick && x_pixels_per_tick < 1000) {
+        gui_generate_ticks(ticks, bounds, plot_range, x_is_time, x_pixels_per_tick * 2);
+        return;
+    }
+
+    tick_idx = 0;
+    for (double y = ticks.y_begin; y < plot_range.y_end && tick_idx < MAX_TICK_MARK_COUNT; y += ticks.y_spacing, ++tick_idx) {
+        if (std::abs(y) < ticks.y_spacing * 1e-3) y = 0.0;
+        snprintf(ticks.y_text[tick_idx], MAX_TICK_MARK_TEXT_LENGTH, "%.14g", y);
+        remove_excessive_trailing_zeros(ticks.y_text[tick_idx], MAX_TICK_MARK_TEXT_LENGTH);
+        ticks.y_text_width[tick_idx] = MeasureTextEx(gps.gui.font_normal, ticks.y_text[tick_idx], gps.gui.fontsize_normal, gps.gui.fontspacing).x;
+        ticks.y_text_width_max = ticks.y_text_width[tick_idx] > ticks.y_text_width_max ? ticks.y_text_width[tick_idx] : ticks.y_text_width_max;
+    }
+}
+
+void gui_loop()
+{
+    Range_XY& plot_range = gps.plot_range;
+    rl::Rectangle& plot_screen = gps.plot_screen;
+    
+    while (true)
+    {
+        plots_mutex.lock();
+        apply_and_reset_gps_update();
+        plots_mutex.unlock();
+                
+        if (!gps.window_is_init && gps.window_visible) {
+            rl::SetConfigFlags(rl::FLAG_WINDOW_RESIZABLE);
+            rl::SetTraceLogLevel(rl::LOG_ERROR);
+            rl::InitWindow(gps.gui.window_width, gps.gui.window_height, "Plotlib");
+            rl::SetTargetFPS(gps.gui.target_fps);
+            gps.gui.font_normal = rl::LoadFontFromMemory(".ttf", gui_font_binary_ttf, gui_font_binary_ttf_len, gps.gui.fontsize_normal, nullptr, 0);
+            gps.gui.font_large = rl::LoadFontFromMemory(".ttf", gui_font_binary_ttf, gui_font_binary_ttf_len, gps.gui.fontsize_large, nullptr, 0);
+            gps.window_is_init = true;
+        }
+
+        if (gps.window_is_init && (rl::WindowShouldClose() || gps.terminate)) {
+            rl::CloseWindow();
+            gps.window_is_init = false;
+            gps.window_visible = false;
+            gps.terminate = false;
+            
+            // This is a special occasions where we need to mutate the 'gps_update' from within the gui-thread.
+            // Overwriting the commands from the api-functions like this should only happen when absolutely necessary.
+            lock_everything(); // the producers waiting for staging room check 'window_visible' under the lock of their shard
+            gps_update.window_visible = false;
+            unlock_everything();
+            gps_update_taken.notify_all(); // nothing takes the staged updates anymore, don't let producers wait for it
+            gps.window_visible = false;
+
+            std::this_thread::sleep_for(std::chrono::microseconds(1000));
+            continue;
+        }
+
+        if (!gps.window_visible) {
+            std::this_thread::sleep_for(std::chrono::microseconds(1000));
+            continue;
+        }
+
+        gps.gui.window_width = rl::GetScreenWidth();
+        gps.gui.window_height = rl::GetScreenHeight();
+
+        rl::Rectangle bounds = {0, 0, (float) gps.gui.window_width, (float) gps.gui.window_height};
+
+        rl::BeginDrawing();
+        {
+            std::lock_guard<std::mutex> plots_lock(plots_mutex); // released before waiting for the next frame in 'EndDrawing'
+            Plot_Group& group = gps.plot_groups[gps.visible_group];
+
+            // Draw Background
+
+            rl::DrawRectangleRec(bounds, gps.gui.colors.backgound);
+
+            // Determine the plot range (The xy-range in plotspace that should be displayed)
+
+            switch (gps.vis_mode.type) {
+            case Visualization_Mode::INTERACTIVE:
+                gui_update_plot_range_interactive_mode(plot_range, plot_screen);
+                break;
+            case Visualization_Mode::SHOW_ENTIRE_PLOT_GROUP:
+                plot_range = bounding_box_of_plots_bounding_boxes(group.plots);
+                break;
+            case Visualization_Mode::SHOW_X_RANGE_OF_TAIL:
+            {
+                plot_range = bounding_box_of_plots_bounding_boxes(group.plots);
+                plot_range.x_begin = plot_range.x_end - gps.vis_mode.x_range;
+                Range_XY visible_bb = { MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE };
+                for (uint64_t i = 0; i < group.plots.size(); ++i) {
+                    grow_bounding_box(visible_bb, bounding_box_of_x_tail(gps.plots[group.plots[i]], plot_range.x_begin));
+                }
+                plot_range.y_begin = visible_bb.y_begin;
+                plot_range.y_end = visible_bb.y_end;
+            }
+            break;
+            case Visualization_Mode::SHOW_N_POINTS_OF_TAIL:
+            {
+                std::vector<Range_XY> bounding_boxes(group.plots.size());
+                for (uint64_t i = 0; i < group.plots.size(); ++i) {
+                    bounding_boxes[i] = bounding_box_of_tail(gps.plots[group.plots[i]], gps.vis_mode.n_points);
+                }
+                plot_range = bounding_box_of_bounding_boxes(bounding_boxes);
+            }
+            break;
+            case Visualization_Mode::SHOW_SPECIFIC_PLOT:
+                assert(gps.vis_mode.specific_plot != INVALID_IDX);
+                plot_range = gps.plots[gps.vis_mode.specific_plot].bb;
+                break;
+            }
+
+            // Fix the plot range if it is malformed
+
+            if (plot_range.x_begin == plot_range.x_end) {
+                plot_range.x_begin -= 0.5;
+                plot_range.x_end += 0.5;
+            }
+            else if (plot_range.x_begin > plot_range.x_end) {
+                plot_range.x_begin = -0.5;
+                plot_range.x_end = 0.5;
+            }
+            
+            if (plot_range.y_begin == plot_range.y_end) {
+                plot_range.y_begin -= 0.5;
+                plot_range.y_end += 0.5;
+            }
+            else if (plot_range.y_begin > plot_range.y_end) {
+                plot_range.y_begin = -0.5;
+                plot_range.y_end = 0.5;
+            }
+
+            auto limit_range_to_tolerable_precision = [](double& range_begin, double& range_end) -> void {
+                double nextafter_begin = std::nextafter(range_begin, std::numeric_limits<double>::infinity());
+                assert(range_end - range_begin  >= 0);
+                assert(nextafter_begin - range_begin >= 0);
+                double precision_correction = (range_end - range_begin) - (nextafter_begin - range_begin) * PRECISION_SAFTEY_FACTOR;
+                if (precision_correction < 0) {
+                    range_begin -= std::abs(precision_correction) / 2.0;
+                    range_end   += std::abs(precision_correction) / 2.0;
+                }  
+            };
+
+            limit_range_to_tolerable_precision(plot_range.x_begin, plot_range.x_end);
+            limit_range_to_tolerable_precision(plot_range.y_begin, plot_range.y_end);
+
+            // Calculate the tick spacing and generate the tick labels, the x axis shows times if any of the plots is timestamped
+
+            bool x_is_time = false;
+            for (uint64_t i = 0; i < group.plots.size(); ++i) {
+                x_is_time = x_is_time || gps.plots[group.plots[i]].is_timestamped();
+            }
+
+            Ticks ticks;
+            gui_generate_ticks(ticks, bounds, plot_range, x_is_time);
+
+            // Draw plot legend
+
+            float legend_content_width = 0;
+            if (gps.visible_group != DEFAULT_PLOT_GROUP_IDX) {
+                legend_content_width = rl::MeasureTextEx(gps.gui.font_large, group.label, gps.gui.fontsize_large, gps.gui.fontspacing).x;
+            }
+            for (uint64_t i = 0; i < group.plots.size(); ++i) {
+                Plot& plot = gps.plots[group.plots[i]];
+                float label_text_width = rl::MeasureTextEx(gps.gui.font_normal, plot.label, gps.gui.fontsize_normal, gps.gui.fontspacing).x;
+                legend_content_width = label_text_width > legend_content_width ? label_text_width : legend_content_width;
+            }
+
+            float legend_x = bounds.x + bounds.width - (legend_content_width + gps.gui.offset_normal);
+            float legend_y = gps.gui.offset_normal;
+            float legend_width = legend_content_width + 2 * gps.gui.offset_normal;
+
+            if (gps.visible_group != DEFAULT_PLOT_GROUP_IDX) {
+                rl::DrawTextEx(gps.gui.font_large, group.label, {legend_x, legend_y}, gps.gui.fontsize_large, gps.gui.fontspacing, gps.gui.colors.text);
+                legend_y += gps.gui.fontsize_large + gps.gui.offset_small;
+                
+                rl::DrawLineV({legend_x, legend_y}, {legend_x + legend_content_width, legend_y}, gps.gui.colors.text);
+                legend_y += gps.gui.offset_small;
+            }
+
+            for (uint64_t i = 0; i < group.plots.size(); ++i) {
+                Plot& plot = gps.plots[group.plots[i]];
+                rl::DrawTextEx(gps.gui.font_normal, plot.label, {legend_x, legend_y}, gps.gui.fontsize_normal, gps.gui.fontspacing, to_rl_color(plot.color));
+                legend_y += gps.gui.fontsize_normal;
+            }
+
+            // Determine the size of the plot-screen (the part of the window where the plots should be drawn into)
+
+            float left_plot_screen_offset = ticks.y_text_width_max + 2 * gps.gui.offset_normal;
+            if (gps.gui.zoom_resize_cooldown > 0) {
+                left_plot_screen_offset = plot_screen.x - bounds.x; // previous offset
+                gps.gui.zoom_resize_cooldown--;
+            }
+            float right_plot_screen_offset = std::max((float) MIN_PLOT_SCREEN_TO_BOUNDS_OFFSET, legend_width);
+            float top_plot_screen_offset = MIN_PLOT_SCREEN_TO_BOUNDS_OFFSET;
+            float bottom_plot_screen_offset = gps.gui.fontsize_normal + gps.gui.offset_normal;
+
+            plot_screen = { bounds.x + left_plot_screen_offset,
+                            bounds.y + top_plot_screen_offset,
+                            bounds.width - (left_plot_screen_offset + right_plot_screen_offset),
+                            bounds.height - (top_plot_screen_offset + bottom_plot_screen_offset) };
+
+            if (plot_screen.width < 1) plot_screen.width = 1;
+            if (plot_screen.height < 1) plot_screen.height = 1;
+
+            auto x_to_screenspace = [=](double x) -> float {
+                return linear_map(x, plot_range.x_begin, plot_range.x_end, (double) plot_screen.x, (double) plot_screen.x + plot_screen.width);
+            };
+
+            auto y_to_screenspace = [=](double y) -> float {
+                return linear_map(y, plot_range.y_begin, plot_range.y_end, (double) plot_screen.y + plot_screen.height, (double) plot_screen.y);
+            };
+
+            // Draw plot_screen border and ticks (tick-lines and tick-labels)
+
+            float bw = gps.gui.plot_screen_border_width;
+            rl::DrawRectangleLinesEx({plot_screen.x - bw, plot_screen.y - bw, plot_screen.width + 2*bw, plot_screen.height + 2*bw},
+                                     bw, gps.gui.colors.plot_screen_border);
+            
+            int tick_idx = 0;
+            for (double x = ticks.x_begin; x < plot_range.x_end; x += ticks.x_spacing, ++tick_idx) {
+                float x_screenspace = x_to_screenspace(x);
+                rl::DrawLine(x_screenspace, plot_screen.y, x_screenspace, plot_screen.y + plot_screen.height, gps.gui.colors.tick_lines);
+                rl::DrawTextEx(gps.gui.font_normal, ticks.x_text[tick_idx], {x_screenspace, plot_screen.y + plot_screen.height},
+                           gps.gui.fontsize_normal, gps.gui.fontspacing, gps.gui.colors.text);
+            }
+            
+            tick_idx = 0;
+            for (double y = ticks.y_begin; y < plot_range.y_end; y += ticks.y_spacing, ++tick_idx) {
+                float y_screenspace = y_to_screenspace(y);
+                rl::DrawLine(plot_screen.x, y_screenspace, plot_screen.x + plot_screen.width, y_screenspace, gps.gui.colors.tick_lines);
+                rl::DrawTextEx(gps.gui.font_normal, ticks.y_text[tick_idx], {bounds.x + gps.gui.offset_normal, y_screenspace - gps.gui.fontsize_normal},
+                           gps.gui.fontsize_normal, gps.gui.fontspacing, gps.gui.colors.text);
+            }
+
+            // Draw in the plot-screen
+            
+            rl::BeginScissorMode(plot_screen.x, plot_screen.y, plot_screen.width, plot_screen.height);
+            {
+                // Draw x=0, y=0 coordinate-axes
+                
+                rl::DrawLineV({plot_screen.x, y_to_screenspace(0)}, {plot_screen.x + plot_screen.width, y_to_screenspace(0)}, gps.gui.colors.coordinate_axes);
+                rl::DrawLineV({x_to_screenspace(0), plot_screen.y}, {x_to_screenspace(0), plot_screen.y + plot_screen.height}, gps.gui.colors.coordinate_axes);
+            
+                // Draw the plots
+                
+                for (uint64_t i = 0; i < group.plots.size(); ++i)
+                {
+                    Plot_IDX plot_idx = group.plots[i];
+                    Plot& plot = gps.plots[plot_idx];
+                    
+                    if (plot.empty()) continue;
+                
+                    uint64_t plot_points_begin_idx = 0;
+                    if (gps.vis_mode.type == Visualization_Mode::SHOW_N_POINTS_OF_TAIL && gps.vis_mode.n_points < plot.points_y.size()) {
+                        plot_points_begin_idx = plot.points_y.size() - gps.vis_mode.n_points;
+                    }
+                    if (gps.vis_mode.type == Visualization_Mode::SHOW_X_RANGE_OF_TAIL && plot.has_x_coordinate()) {
+                        // The line enters the view from the last point before it.
+                        uint64_t first_visible_idx = first_index_at_x(plot, plot_range.x_begin);
+                        plot_points_begin_idx = first_visible_idx > 0 ? first_visible_idx - 1 : 0;
+                    }
+
+                    Sample_Reader points_x(plot.points_x);
+                    Sample_Reader points_y(plot.points_y);
+
+                    auto draw_line = [&](rl::Vector2 from, rl::Vector2 to) {
+                        // Plotting with width 1.0 implicitly explicitly with DrawLineV looks much worse than with DrawLineEx
+                        if (plot.line_width == 1.0)
+                            rl::DrawLineV(from, to, to_rl_color(plot.color));
+                        else
+                            rl::DrawLineEx(from, to, plot.line_width, to_rl_color(plot.color));
+                    };
+
+                    // Blocks outside of the view are skipped and blocks narrower than a pixel are drawn as a line from their lowest
+                    // to their highest value. Their values aren't read, so spilled or compressed values are only read once they are shown.
+                    bool has_block_bounds = !plot.block_bounds.empty() && plot.bounded_until == plot.evicted_count + plot.points_y.size();
+                    auto draw_block = [&](const Block_Bounds& block, float& x_prev, float& y_prev) -> bool {
+                        bool outside = block.bb.x_end < plot_range.x_begin || block.bb.x_begin > plot_range.x_end ||
+                                       block.bb.y_end < plot_range.y_begin || block.bb.y_begin > plot_range.y_end;
+                        float x_begin = x_to_screenspace(block.bb.x_begin);
+                        float x_end = x_to_screenspace(block.bb.x_end);
+                        if (!outside && x_end - x_begin >= 1) return false;
+                        if (plot.show_lines) {
+                            draw_line({x_prev, y_prev}, {x_to_screenspace(block.first.x), y_to_screenspace(block.first.y)});
+                        }
+                        if (!outside) {
+                            float x = (x_begin + x_end) / 2;
+                            draw_line({x, y_to_screenspace(block.bb.y_begin)}, {x, y_to_screenspace(block.bb.y_end)});
+                        }
+                        x_prev = x_to_screenspace(block.last.x);
+                        y_prev = y_to_screenspace(block.last.y);
+                        return true;
+                    };
+
+                    if (plot.has_x_coordinate()) {
+                        float x_prev = x_to_screenspace(points_x[plot_points_begin_idx]);
+                        float y_prev = y_to_screenspace(points_y[plot_points_begin_idx]);
+        
+                        for (uint64_t i = plot_points_begin_idx + 1; i < plot.points_y.size(); ++i) {
+                            uint64_t value_idx = plot.evicted_count + i;
+                            if (has_block_bounds && value_idx % BOUNDS_BLOCK_LENGTH == 0 &&
+                                draw_block(plot.block_bounds[value_idx / BOUNDS_BLOCK_LENGTH - plot.first_block], x_prev, y_prev)) {
+                                i = std::min<uint64_t>(i + BOUNDS_BLOCK_LENGTH, plot.points_y.size()) - 1;
+                                continue;
+                            }
+                            float x = x_to_screenspace(points_x[i]);
+                            float y = y_to_screenspace(points_y[i]);
+                            if (plot.show_lines) {
+                                draw_line({x_prev, y_prev}, {x, y});
+                            }
+                            if (plot.show_points) {
+                                rl::DrawCircleV({x, y}, plot.point_diameter/2.0, to_rl_color(plot.color));
+                            }
+                            x_prev = x;
+                            y_prev = y;
+                        }
+                    }
+                    else {
+                        // Only the visible numbers are read, so the pages of a loaded file are read in once they are shown.
+                        uint64_t plot_points_end_idx = plot.points_y.size();
+                        double x_begin_idx = plot.implicit_index_of(plot_range.x_begin);
+                        double x_end_idx = plot.implicit_index_of(plot_range.x_end);
+                        if (x_begin_idx > plot_points_begin_idx) {
+                            plot_points_begin_idx = x_begin_idx < plot_points_end_idx ? (uint64_t) x_begin_idx : plot_points_end_idx - 1;
+                        }
+                        if (x_end_idx + 1 < plot_points_end_idx) {
+                            plot_points_end_idx = x_end_idx < 0 ? 1 : (uint64_t) std::ceil(x_end_idx) + 1;
+                        }
+                        if (plot_points_begin_idx >= plot_points_end_idx) continue;
+
+                        float x_prev = x_to_screenspace(plot.implicit_x_of(plot_points_begin_idx));
+                        float y_prev = y_to_screenspace(points_y[plot_points_begin_idx]);
+        
+                        for (uint64_t i = plot_points_begin_idx + 1; i < plot_points_end_idx; ++i) {
+                            uint64_t value_idx = plot.evicted_count + i;
+                            if (has_block_bounds && value_idx % BOUNDS_BLOCK_LENGTH == 0 &&
+                                draw_block(plot.block_bounds[value_idx / BOUNDS_BLOCK_LENGTH - plot.first_block], x_prev, y_prev)) {
+                                i = std::min<uint64_t>(i + BOUNDS_BLOCK_LENGTH, plot.points_y.size()) - 1;
+                                continue;
+                            }
+                            float x = x_to_screenspace(plot.implicit_x_of(i));
+                            float y = y_to_screenspace(points_y[i]);
+                            if (plot.show_lines) {
+                                draw_line({x_prev, y_prev}, {x, y});
+                            }
+                            if (plot.show_points) {
+                                rl::DrawCircleV({x, y}, plot.point_diameter/2.0, to_rl_color(plot.color));
+                            }
+                            x_prev = x;
+                            y_prev = y;
+                        }
+                    }
+                }
+            }
+            rl::EndScissorMode();
+
+            // Draw ticks marks (they have to be drawn over the plots)
+
+            tick_idx = 0;
+            for (double x = ticks.x_begin; x < plot_range.x_end; x += ticks.x_spacing, ++tick_idx) {
+                float x_screenspace = x_to_screenspace(x);
+                rl::DrawLineEx({x_screenspace, plot_screen.y + plot_screen.height - gps.gui.tick_mark_len}, {x_screenspace, plot_screen.y + plot_screen.height},
+                               gps.gui.plot_screen_border_width, gps.gui.colors.plot_screen_border);
+            }
+            
+            tick_idx = 0;
+            for (double y = ticks.y_begin; y < plot_range.y_end; y += ticks.y_spacing, ++tick_idx) {
+                float y_screenspace = y_to_screenspace(y);
+                rl::DrawLineEx({plot_screen.x, y_screenspace}, {plot_screen.x + gps.gui.tick_mark_len, y_screenspace},
+                               gps.gui.plot_screen_border_width, gps.gui.colors.plot_screen_border);
+            }
+        }
+        rl::EndDrawing();
+    }
+}
+
+static void start_gui_thread() {
+    static std::thread gui_thread(gui_loop);
+    gui_thread.detach();
+}
+
+static void start_gui_thread_if_not_started() {
+    static bool started_gui_thread = false;
+    if (!started_gui_thread) {
+        start_gui_thread();
+        started_gui_thread = true;
+    }
+}
+
+// The append functions go through here, instead of taking the lock of the shard, once the plot has an append ring.
+static bool push_to_append_ring(Plot_IDX plot_idx, Append_Ring* ring, const double* x, uint64_t x_stride, const double* y, uint64_t y_stride,
+                                uint64_t count)
+{
+    if (!ring->accepts(x ? Append_Ring::POINTS : Append_Ring::NUMBERS)) {
+        printf(ERROR "The append ring of the Plot with index '%d' holds %s and cannot be appended with %s.\n", plot_idx,
+               x ? "numbers" : "points", x ? "points" : "numbers");
+        return false;
+    }
+    return ring->push(x, x_stride, y, y_stride, count);
+}
+
+// A batch records the api calls of one thread instead of applying them. 'plotlib_commit' applies all of them while holding
+// every lock at once, so the gui-thread picks them up in the same frame.
+struct Batch {
+    bool active = false;
+    bool committing = false;
+    std::vector<std::function<bool()>> commands;
+};
+
+static thread_local Batch batch;
+
+// Every api function changes 'gps_update' through one of the submit functions. The command runs while holding the lock
+// which guards what it changes, or is recorded if this thread is in a batch. Recorded commands can't fail the api call,
+// they report their errors on commit.
+
+// For commands which only change the global state and the plot groups.
+template <typename Command>
+static bool submit(Command command)
+{
+    if (batch.active) {
+        batch.commands.push_back(command);
+        return true;
+    }
+    gps_update_mutex.lock();
+    bool success = command();
+    gps_update_mutex.unlock();
+    return success;
+}
+
+// For commands which only change the update of 'plot_idx', only its shard is locked.
+template <typename Command>
+static bool submit_to_plot(Plot_IDX plot_idx, Command command)
+{
+    if (batch.active) {
+        batch.commands.push_back(command);
+        return true;
+    }
+    Plot_Shard& shard = gps_update.shard_of(plot_idx);
+    shard.mutex.lock();
+    bool success = command();
+    shard.mutex.unlock();
+    return success;
+}
+
+// For the rare commands which change the global state together with plot updates.
+template <typename Command>
+static bool submit_to_everything(Command command)
+{
+    if (batch.active) {
+        batch.commands.push_back(command);
+        return true;
+    }
+    lock_everything();
+    bool success = command();
+    unlock_everything();
+    return success;
+}
+
+static void free_values(void* values)
+{
+    free(values);
+}
+
+static Staging_Limit staging_limit_of(Plot_IDX plot_idx)
+{
+    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+    return plot_update.has_staging_limit ? plot_update.staging_limit : gps_update.staging_limit;
+}
+
+// The BLOCK policy waits until the gui-thread took the staged values. Nothing takes them while the window is hidden and a
+// batch can't wait half-way through its commit, so both drop the newest values instead.
+static void wait_for_staging_room(Plot_IDX plot_idx, uint64_t length)
+{
+    Staging_Limit limit = staging_limit_of(plot_idx);
+    if (limit.policy != PLOTLIB_STAGING_BLOCK || batch.committing) return;
+
+    Sample_Buffer& staged = gps_update.plot_updates[plot_idx].new_points_y;
+    while (gps_update.window_visible && !staged.empty() && staged.size() + length > limit.max_values) {
+        gps_update_taken.wait(gps_update.shard_of(plot_idx).mutex);
+    }
+}
+
+// Returns how many of the 'length' new values may be staged, the remaining ones are dropped.
+static uint64_t staging_room(Plot_IDX plot_idx, uint64_t length, bool fill)
+{
+    Staging_Limit limit = staging_limit_of(plot_idx);
+    uint64_t staged = gps_update.plot_updates[plot_idx].new_points_y.size();
+
+    switch (limit.policy) {
+    case PLOTLIB_STAGING_BLOCK:
+        if (staged == 0 && gps_update.window_visible && !batch.committing) return length; // too large to ever fit otherwise
+        break;
+    case PLOTLIB_STAGING_KEEP_LATEST_FILL:
+        if (fill) return length;
+        break;
+    case PLOTLIB_STAGING_DROP_NEWEST:
+        break;
+    default:
+        return length;
+    }
+
+    uint64_t room = limit.max_values > staged ? limit.max_values - staged : 0;
+    return std::min(room, length);
+}
+
+// The DROP_OLDEST policy stages everything and then drops the oldest values which don't fit anymore.
+static void drop_oldest_staged_values(Plot_IDX plot_idx)
+{
+    Staging_Limit limit = staging_limit_of(plot_idx);
+    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+    if (limit.policy != PLOTLIB_STAGING_DROP_OLDEST || plot_update.new_points_y.size() <= limit.max_values) return;
+
+    uint64_t drop_count = plot_update.new_points_y.size() - limit.max_values;
+    if (!plot_update.new_points_x.empty()) {
+        plot_update.new_points_x.erase_front(drop_count);
+    }
+    plot_update.new_points_y.erase_front(drop_count);
+    plot_update.dropped_count += drop_count;
+    plot_update.bounded_length = 0;
+}
+
+// Stages numbers for the plot, they are converted from 'sample_type' to double and are 'stride' bytes apart. If 'memory' is
+// set the (dense double) numbers are borrowed and referenced instead of copied, as long as nothing else is staged for the plot.
+static bool stage_numbers(Plot_IDX plot_idx, const void* numbers, uint32_t sample_type, uint64_t stride, uint64_t length, bool fill,
+                          const std::shared_ptr<Borrowed_Memory>& memory)
+{
+    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+    if (fill) {
+        plot_update.clear_plot();
+    }
+    else {
+        wait_for_staging_room(plot_idx, length);
+        if (plot_update.contains_points) {
+            printf(ERROR "The Plot with index '%d' contains points and cannot be appended with numbers.\n", plot_idx);
+            return false;
+        }
+    }
+
+    uint64_t accepted_length = staging_room(plot_idx, length, fill);
+    if (memory && plot_update.new_points_y.empty()) {
+        assert(sample_type == PLOTLIB_SAMPLE_F64 && stride == sizeof(double));
+        plot_update.new_points_y.borrow((const double*) numbers, accepted_length, memory);
+    }
+    else if (accepted_length > 0) {
+        uint64_t old_size = plot_update.new_points_y.size();
+        plot_update.new_points_y.resize(old_size + accepted_length);
+        convert_samples_to_double((const uint8_t*) numbers, sample_type, stride, accepted_length, &plot_update.new_points_y[old_size]);
+    }
+    plot_update.contains_numbers = true;
+    gps_update.mark_plot_dirty(plot_idx);
+
+    drop_oldest_staged_values(plot_idx);
+    plot_update.dropped_count += length - accepted_length;
+    return accepted_length == length;
+}
+
+// Like 'stage_numbers', 'x_stride' and 'y_stride' are the distances in bytes between two consecutive x and y values.
+// Borrowed points are always dense.
+static bool stage_points(Plot_IDX plot_idx, const void* points_x, uint64_t x_stride, const void* points_y, uint64_t y_stride,
+                         uint32_t sample_type, uint64_t length, bool fill, const std::shared_ptr<Borrowed_Memory>& memory)
+{
+    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+    if (fill) {
+        plot_update.clear_plot();
+    }
+    else {
+        wait_for_staging_room(plot_idx, length);
+        if (plot_update.contains_numbers) {
+            printf(ERROR "The Plot with index '%d' contains numbers and cannot be appended with points.\n", plot_idx);
+            return false;
+        }
+        if (plot_update.timestamped) {
+            printf(ERROR "The Plot with index '%d' is timestamped and can only be appended with timestamped values.\n", plot_idx);
+            return false;
+        }
+    }
+
+    uint64_t accepted_length = staging_room(plot_idx, length, fill);
+    if (plot_update.new_points_x.is_encoded()) {
+        assert(plot_update.new_points_x.empty());
+        plot_update.new_points_x.set_encoding(Sample_Encoding{}); // it held timestamps before it was swapped
+    }
+    if (memory && plot_update.new_points_y.empty()) {
+        assert(sample_type == PLOTLIB_SAMPLE_F64 && x_stride == sizeof(double) && y_stride == sizeof(double));
+        plot_update.new_points_x.borrow((const double*) points_x, accepted_length, memory);
+        plot_update.new_points_y.borrow((const double*) points_y, accepted_length, memory);
+    }
+    else if (accepted_length > 0) {
+        uint64_t old_size = plot_update.new_points_y.size();
+        plot_update.new_points_x.resize(old_size + accepted_length);
+        plot_update.new_points_y.resize(old_size + accepted_length);
+        convert_samples_to_double((const uint8_t*) points_x, sample_type, x_stride, accepted_length, &plot_update.new_points_x[old_size]);
+        convert_samples_to_double((const uint8_t*) points_y, sample_type, y_stride, accepted_length, &plot_update.new_points_y[old_size]);
+    }
+    plot_update.contains_points = true;
+    gps_update.mark_plot_dirty(plot_idx);
+
+    drop_oldest_staged_values(plot_idx);
+    plot_update.dropped_count += length - accepted_length;
+    return accepted_length == length;
+}
+
+// The append ring and the copies of a batch hold doubles, other sample types are converted on the calling thread first.
+static thread_local std::vector<double> converted_samples;
+
+// Whether the doubles can be read in place, they are read one by one otherwise.
+static bool aligned_doubles(uint32_t sample_type, const void* values, uint64_t stride)
+{
+    return sample_type == PLOTLIB_SAMPLE_F64 && (uintptr_t) values % alignof(double) == 0 && stride % alignof(double) == 0;
+}
+
+// All fill and append functions for numbers go through here, 'stride' is the distance in bytes between two numbers.
+// Appends go into the append ring instead if the plot has one. A batch records them like everything else and pushes its copy
+// into the ring when it is committed, the gui-thread only drains what was pushed before it took the staged updates.
+static bool submit_numbers(Plot_IDX plot_idx, const void* numbers, uint32_t sample_type, uint64_t stride, uint64_t length, bool fill,
+                           std::shared_ptr<Borrowed_Memory> memory)
+{
+    Append_Ring* ring = fill ? nullptr : gps_update.plot_updates[plot_idx].append_ring.load(std::memory_order_acquire);
+    if (ring && !batch.active) {
+        if (aligned_doubles(sample_type, numbers, stride)) {
+            return push_to_append_ring(plot_idx, ring, nullptr, 0, (const double*) numbers, stride / sizeof(double), length);
+        }
+        converted_samples.resize(length);
+        convert_samples_to_double((const uint8_t*) numbers, sample_type, stride, length, converted_samples.data());
+        return push_to_append_ring(plot_idx, ring, nullptr, 0, converted_samples.data(), 1, length);
+    }
+
+    if (batch.active && !memory) {
+        double* copy = (double*) malloc(length * sizeof(double));
+        convert_samples_to_double((const uint8_t*) numbers, sample_type, stride, length, copy);
+        numbers = copy;
+        sample_type = PLOTLIB_SAMPLE_F64;
+        stride = sizeof(double);
+        memory = std::make_shared<Borrowed_Memory>(free_values, copy);
+    }
+
+    if (ring) { // the values are dense doubles now
+        return submit_to_plot(plot_idx, [=, memory = std::move(memory)] {
+            return push_to_append_ring(plot_idx, ring, nullptr, 0, (const double*) numbers, 1, length);
+        });
+    }
+    return submit_to_plot(plot_idx, [=] {
+        return stage_numbers(plot_idx, numbers, sample_type, stride, length, fill, memory);
+    });
+}
+
+static bool submit_points(Plot_IDX plot_idx, const void* points_x, uint64_t x_stride, const void* points_y, uint64_t y_stride,
+                          uint32_t sample_type, uint64_t length, bool fill, std::shared_ptr<Borrowed_Memory> memory)
+{
+    Append_Ring* ring = fill ? nullptr : gps_update.plot_updates[plot_idx].append_ring.load(std::memory_order_acquire);
+    if (ring && !batch.active) {
+        if (aligned_doubles(sample_type, points_x, x_stride) && aligned_doubles(sample_type, points_y, y_stride)) {
+            return push_to_append_ring(plot_idx, ring, (const double*) points_x, x_stride / sizeof(double),
+                                       (const double*) points_y, y_stride / sizeof(double), length);
+        }
+        converted_samples.resize(2 * length);
+        convert_samples_to_double((const uint8_t*) points_x, sample_type, x_stride, length, converted_samples.data());
+        convert_samples_to_double((const uint8_t*) points_y, sample_type, y_stride, length, converted_samples.data() + length);
+        return push_to_append_ring(plot_idx, ring, converted_samples.data(), 1, converted_samples.data() + length, 1, length);
+    }
+
+    if (batch.active && !memory) {
+        double* copy = (double*) malloc(2 * length * sizeof(double));
+        convert_samples_to_double((const uint8_t*) points_x, sample_type, x_stride, length, copy);
+        convert_samples_to_double((const uint8_t*) points_y, sample_type, y_stride, length, copy + length);
+        points_x = copy;
+        points_y = copy + length;
+        sample_type = PLOTLIB_SAMPLE_F64;
+        x_stride = y_stride = sizeof(double);
+        memory = std::make_shared<Borrowed_Memory>(free_values, copy);
+    }
+
+    if (ring) { // like in 'submit_numbers', the points are dense doubles now
+        return submit_to_plot(plot_idx, [=, memory = std::move(memory)] {
+            return push_to_append_ring(plot_idx, ring, (const double*) points_x, 1, (const double*) points_y, 1, length);
+        });
+    }
+    return submit_to_plot(plot_idx, [=] {
+        return stage_points(plot_idx, points_x, x_stride, points_y, y_stride, sample_type, length, fill, memory);
+    });
+}
+
+PLOTAPI bool plotlib_begin_batch()
+{
+    if (batch.active) {
+        printf(ERROR "This thread already started a batch, it has to be committed before starting a new one.\n");
+        return false;
+    }
+    batch.active = true;
+    return true;
+}
+
+PLOTAPI bool plotlib_commit()
+{
+    if (!batch.active) {
+        printf(ERROR "This thread has no batch to commit, start one with 'plotlib_begin_batch'.\n");
+        return false;
+    }
+    batch.active = false;
+
+    bool success = true;
+    lock_everything();
+    batch.committing = true;
+    for (size_t i = 0; i < batch.commands.size(); ++i) {
+        success &= batch.commands[i]();
+    }
+    batch.committing = false;
+    unlock_everything();
+
+    batch.commands.clear();
+    return success;
+}
+
+PLOTAPI void plotlib_show()
+{
+    submit([] {
+        gps_update.window_visible = true;
+        start_gui_thread_if_not_started();
+        return true;
+    });
+}
+
+PLOTAPI void plotlib_hide()
+{
+    submit([] {
+        gps_update.terminate = true;
+        return true;
+    });
+}
+
+PLOTAPI void plotlib_dark_theme()
+{
+    submit([] {
+        gps_update.theme_colors = dark_theme_colors;
+        return true;
+    });
+}
+
+PLOTAPI void plotlib_light_theme()
+{
+    submit([] {
+        gps_update.theme_colors = light_theme_colors;
+        return true;
+    });
+}
+
+PLOTAPI void plotlib_mode_interactive()
+{
+    submit([] {
+        gps_update.vis_mode = Visualization_Mode { .type=Visualization_Mode::INTERACTIVE };
+        return true;
+    });
+}
+
+PLOTAPI void plotlib_mode_show_n_points_of_tail(uint64_t points_count)
+{
+    submit([=] {
+        gps_update.vis_mode = Visualization_Mode { .type=Visualization_Mode::SHOW_N_POINTS_OF_TAIL, .n_points=points_count };
+        return true;
+    });
+}
+
+PLOTAPI void plotlib_mode_show_x_range_of_tail(double x_range)
+{
+    submit([=] {
+        gps_update.vis_mode = Visualization_Mode { .type=Visualization_Mode::SHOW_X_RANGE_OF_TAIL, .x_range=x_range };
+        return true;
+    });
+}
+
+PLOTAPI void plotlib_mode_fill_window()
+{
+    submit([] {
+        gps_update.vis_mode = Visualization_Mode { .type=Visualization_Mode::SHOW_ENTIRE_PLOT_GROUP };
+        return true;
+    });
+}
+
+PLOTAPI bool plotlib_mode_show_specific_plot(uint32_t plot_idx)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit([=] {
+        gps_update.vis_mode = Visualization_Mode { .type=Visualization_Mode::SHOW_SPECIFIC_PLOT, .specific_plot=plot_idx };
+        return true;
+    });
+}
+
+PLOTAPI void plotlib_clear_all_plots()
+{
+    submit_to_everything([] {
+        Plot_Table<Plot_Update>& plot_updates = gps_update.plot_updates;
+        Plot_IDX plots_end = std::min(plot_updates.end(), plot_handle_end.load(std::memory_order_acquire)); // not the unused handles
+        for (Plot_IDX plot_idx = plot_updates.first(); plot_idx < plots_end; plot_idx = plot_updates.next(plot_idx)) {
+            plot_updates[plot_idx].clear_plot();
+            gps_update.mark_plot_dirty(plot_idx);
+        }
+        for (Group_IDX group_idx = 0; group_idx < MAX_PLOT_GROUP_SIZE; ++group_idx) {
+            gps_update.plot_group_updates[group_idx].clear_group();
+            gps_update.mark_group_dirty(group_idx);
+        }
+        return true;
+    });
+}
+
+PLOTAPI bool plot_show(Plot_IDX plot_idx)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit_to_everything([=] {
+        Plot_Group_Update& group_update = gps_update.plot_group_updates[DEFAULT_PLOT_GROUP_IDX];
+
+        if (gps_update.visible_group != DEFAULT_PLOT_GROUP_IDX) {
+            group_update.clear_group();
+        }
+
+        group_update.new_plots.push_back(plot_idx);
+        gps_update.mark_group_dirty(DEFAULT_PLOT_GROUP_IDX);
+        gps_update.mark_plot_dirty(plot_idx); // initialize the plot
+        gps_update.visible_group = DEFAULT_PLOT_GROUP_IDX;
+        gps_update.window_visible = true;
+        start_gui_thread_if_not_started();
+        return true;
+    });
+}
+
+PLOTAPI bool plot_as_lines(uint32_t plot_idx, double line_width)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit_to_plot(plot_idx, [=] {
+        gps_update.plot_updates[plot_idx].show_lines = true;
+        gps_update.plot_updates[plot_idx].show_points = false;
+        gps_update.plot_updates[plot_idx].line_width = line_width;
+        gps_update.mark_plot_dirty(plot_idx);
+        return true;
+    });
+}
+
+PLOTAPI bool plot_as_scatter(uint32_t plot_idx, double diameter)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit_to_plot(plot_idx, [=] {
+        gps_update.plot_updates[plot_idx].show_points = true;
+        gps_update.plot_updates[plot_idx].show_lines = false;
+        gps_update.plot_updates[plot_idx].point_diameter = diameter;
+        gps_update.mark_plot_dirty(plot_idx);
+        return true;
+    });
+}
+
+PLOTAPI bool plot_as_scatterlines(uint32_t plot_idx, double line_width, double diameter)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit_to_plot(plot_idx, [=] {
+        gps_update.plot_updates[plot_idx].show_points = true;
+        gps_update.plot_updates[plot_idx].show_lines = true;
+        gps_update.plot_updates[plot_idx].line_width = line_width;
+        gps_update.plot_updates[plot_idx].point_diameter = diameter;
+        gps_update.mark_plot_dirty(plot_idx);
+        return true;
+    });
+}
+
+PLOTAPI bool plot_hide(Plot_IDX plot_idx)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit([=] {
+        gps_update.plot_group_updates[DEFAULT_PLOT_GROUP_IDX].remove_plots.push_back(plot_idx);
+        gps_update.mark_group_dirty(DEFAULT_PLOT_GROUP_IDX);
+        return true;
+    });
+}
+
+PLOTAPI void plot_hide_all()
+{
+    submit([] {
+        gps_update.plot_group_updates[DEFAULT_PLOT_GROUP_IDX].clear_group();
+        gps_update.mark_group_dirty(DEFAULT_PLOT_GROUP_IDX);
+        return true;
+    });
+}
+
+PLOTAPI bool plot_clear(uint32_t plot_idx)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit_to_plot(plot_idx, [=] {
+        gps_update.plot_updates[plot_idx].clear_plot();
+        gps_update.mark_plot_dirty(plot_idx);
+        return true;
+    });
+}
+
+PLOTAPI bool plot_set_color(uint32_t plot_idx, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit_to_plot(plot_idx, [=] {
+        gps_update.plot_updates[plot_idx].custom_color = Color{r, g, b, a};
+        gps_update.plot_updates[plot_idx].has_custom_color = true;
+        gps_update.mark_plot_dirty(plot_idx);
+        return true;
+    });
+}
+
+PLOTAPI bool plot_set_name(uint32_t plot_idx, const char* name)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    std::shared_ptr<char> name_copy(new char[strlen(name) + 1], std::default_delete<char[]>());
+    strcpy(name_copy.get(), name);
+    return submit_to_plot(plot_idx, [=] {
+        Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+        delete[] plot_update.new_name;
+        plot_update.new_name = new char[strlen(name_copy.get()) + 1];
+        strcpy(plot_update.new_name, name_copy.get());
+        gps_update.mark_plot_dirty(plot_idx);
+        return true;
+    });
+}
+
+// Returns the handle of the plot named 'name', the plot is created with the next free handle after the fixed plot indices
+// if there is none yet. The handle is a plot index for all other functions. Returns PLOTLIB_NO_IDX once all handles are used.
+PLOTAPI uint32_t plot_create(const char* name)
+{
+    if (!name) {
+        printf(ERROR "A plot needs a name to be created.\n");
+        return PLOTLIB_NO_IDX;
+    }
+    gps_update_mutex.lock();
+    auto handle = gps_update.plot_handles.find(name);
+    if (handle != gps_update.plot_handles.end()) {
+        Plot_IDX plot_idx = handle->second;
+        gps_update_mutex.unlock();
+        return plot_idx;
+    }
+    Plot_IDX plot_idx = plot_handle_end.load(std::memory_order_relaxed);
+    if (plot_idx >= MAX_PLOT_HANDLE_COUNT) {
+        gps_update_mutex.unlock();
+        printf(ERROR "All %d plot handles are in use.\n", MAX_PLOT_HANDLE_COUNT - MAX_PLOT_SIZE);
+        return PLOTLIB_NO_IDX;
+    }
+    gps_update.plot_handles.emplace(name, plot_idx);
+    plot_handle_end.store(plot_idx + 1, std::memory_order_release);
+    gps_update_mutex.unlock();
+
+    plot_set_name(plot_idx, name);
+    return plot_idx;
+}
+
+// Returns the handle of the plot which 'plot_create' created with 'name', or PLOTLIB_NO_IDX.
+PLOTAPI uint32_t plot_find(const char* name)
+{
+    if (!name) return PLOTLIB_NO_IDX;
+    gps_update_mutex.lock();
+    auto handle = gps_update.plot_handles.find(name);
+    Plot_IDX plot_idx = handle != gps_update.plot_handles.end() ? handle->second : PLOTLIB_NO_IDX;
+    gps_update_mutex.unlock();
+    return plot_idx;
+}
+
+PLOTAPI bool plot_fill_numbers(uint32_t plot_idx, double* numbers, uint64_t length)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit_numbers(plot_idx, numbers, PLOTLIB_SAMPLE_F64, sizeof(double), length, true, nullptr);
+}
+
+PLOTAPI bool plot_fill_points_x_y(uint32_t plot_idx, double* points_x, double* points_y, uint64_t length)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit_points(plot_idx, points_x, sizeof(double), points_y, sizeof(double), PLOTLIB_SAMPLE_F64, length, true, nullptr);
+}
+
+PLOTAPI bool plot_fill_points_xy(uint32_t plot_idx, double* points_xy, uint64_t length)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    if (length % 2 != 0) {
+        printf(ERROR "The length provided is not divisible by 2 but 'plot_fill_points_xy' expects an array of Points.\n");
+        return false;
+    }
+    return submit_points(plot_idx, points_xy, 2 * sizeof(double), points_xy + 1, 2 * sizeof(double), PLOTLIB_SAMPLE_F64, length / 2,
+                         true, nullptr);
+}
+
+static bool valid_sample_type(uint32_t sample_type)
+{
+    if (sample_type_size(sample_type) == 0) {
+        printf(ERROR "The sample type '%u' is unknown.\n", sample_type);
+        return false;
+    }
+    return true;
+}
+
+PLOTAPI bool plot_fill_numbers_typed(uint32_t plot_idx, const void* numbers, uint32_t sample_type, uint64_t length)
+{
+    if (!valid_plot_idx(plot_idx) || !valid_sample_type(sample_type)) return false;
+    return submit_numbers(plot_idx, numbers, sample_type, sample_type_size(sample_type), length, true, nullptr);
+}
+
+PLOTAPI bool plot_fill_points_x_y_typed(uint32_t plot_idx, const void* points_x, const void* points_y, uint32_t sample_type, uint64_t length)
+{
+    if (!valid_plot_idx(plot_idx) || !valid_sample_type(sample_type)) return false;
+    uint64_t stride = sample_type_size(sample_type);
+    return submit_points(plot_idx, points_x, stride, points_y, stride, sample_type, length, true, nullptr);
+}
+
+// The strided variants read every value 'stride' bytes after the previous one, e.g. the fields of an array of structs with
+// 'stride = sizeof(struct)'. The values don't have to be aligned.
+
+PLOTAPI bool plot_fill_numbers_strided(uint32_t plot_idx, const void* numbers, uint64_t stride, uint32_t sample_type, uint64_t length)
+{
+    if (!valid_plot_idx(plot_idx) || !valid_sample_type(sample_type)) return false;
+    return submit_numbers(plot_idx, numbers, sample_type, stride, length, true, nullptr);
+}
+
+PLOTAPI bool plot_fill_points_strided(uint32_t plot_idx, const void* points_x, uint64_t x_stride, const void* points_y, uint64_t y_stride,
+                                      uint32_t sample_type, uint64_t length)
+{
+    if (!valid_plot_idx(plot_idx) || !valid_sample_type(sample_type)) return false;
+    return submit_points(plot_idx, points_x, x_stride, points_y, y_stride, sample_type, length, true, nullptr);
+}
+
+// Timestamped values have int64 nanosecond timestamps (e.g. since the unix epoch) as x coordinates. The timestamps are
+// staged and stored as they are, the time origin is only subtracted in integer arithmetic when they are read as doubles.
+static bool stage_timestamped(Plot_IDX plot_idx, const int64_t* timestamps, const double* values, uint64_t length, bool fill, int64_t origin)
+{
+    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+    if (fill) {
+        plot_update.clear_plot();
+    }
+    else {
+        wait_for_staging_room(plot_idx, length);
+        if (plot_update.contains_numbers) {
+            printf(ERROR "The Plot with index '%d' contains numbers and cannot be appended with points.\n", plot_idx);
+            return false;
+        }
+    }
+
+    Sample_Encoding timestamp_encoding = { PLOTLIB_SAMPLE_I64, 1.0 / NANOSECONDS_PER_SECOND, 0.0, origin };
+    if (length > 0 && !plot_update.timestamped) {
+        plot_update.timestamped = true;
+        plot_update.x_storage_changed = true;
+        plot_update.x_storage_encoding = timestamp_encoding;
+    }
+
+    uint64_t accepted_length = staging_room(plot_idx, length, fill);
+    if (accepted_length > 0) {
+        Sample_Buffer& staged_x = plot_update.new_points_x;
+        if (staged_x.encoding.sample_type != PLOTLIB_SAMPLE_I64) {
+            staged_x.set_encoding(timestamp_encoding); // converts the points which were staged before the plot became timestamped
+        }
+        uint64_t old_size = plot_update.new_points_y.size();
+        staged_x.resize(old_size + accepted_length);
+        plot_update.new_points_y.resize(old_size + accepted_length);
+        write_encoded_samples(staged_x, old_size, (const uint8_t*) timestamps, accepted_length);
+        convert_samples_to_double((const uint8_t*) values, PLOTLIB_SAMPLE_F64, sizeof(double), accepted_length, &plot_update.new_points_y[old_size]);
+    }
+    plot_update.contains_points = true;
+    gps_update.mark_plot_dirty(plot_idx);
+
+    drop_oldest_staged_values(plot_idx);
+    plot_update.dropped_count += length - accepted_length;
+    return accepted_length == length;
+}
+
+// The append ring holds doubles, so timestamps are always staged. A batch stages a copy of them when it is committed.
+static bool submit_timestamped(Plot_IDX plot_idx, const int64_t* timestamps, const double* values, uint64_t length, bool fill)
+{
+    if (!fill && gps_update.plot_updates[plot_idx].append_ring.load(std::memory_order_acquire)) {
+        printf(ERROR "The Plot with index '%d' has an append ring, which can't hold timestamps exactly.\n", plot_idx);
+        return false;
+    }
+
+    int64_t origin = NO_TIME_ORIGIN;
+    if (length > 0) {
+        time_origin.compare_exchange_strong(origin, timestamps[0]);
+        origin = time_origin.load();
+    }
+
+    std::shared_ptr<Borrowed_Memory> batch_copy;
+    if (batch.active) {
+        uint8_t* copy = (uint8_t*) malloc(std::max<uint64_t>(1, length * (sizeof(int64_t) + sizeof(double))));
+        if (length > 0) {
+            memcpy(copy, timestamps, length * sizeof(int64_t));
+            memcpy(copy + length * sizeof(int64_t), values, length * sizeof(double));
+        }
+        timestamps = (const int64_t*) copy;
+        values = (const double*) (copy + length * sizeof(int64_t));
+        batch_copy = std::make_shared<Borrowed_Memory>(free_values, copy);
+    }
+
+    return submit_to_plot(plot_idx, [=, batch_copy = std::move(batch_copy)] {
+        return stage_timestamped(plot_idx, timestamps, values, length, fill, origin);
+    });
+}
+
+PLOTAPI bool plot_fill_timestamped(uint32_t plot_idx, const int64_t* timestamps_ns, const double* values, uint64_t length)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit_timestamped(plot_idx, timestamps_ns, values, length, true);
+}
+
+// The plot stores its y values as 'sample_type', the stored sample 's' is the value 's * scale + offset'. Integer samples
+// are rounded and clamped to their range. The x values of points are always stored as doubles.
+PLOTAPI bool plot_set_storage(uint32_t plot_idx, uint32_t sample_type, double scale, double offset)
+{
+    if (!valid_plot_idx(plot_idx) || !valid_sample_type(sample_type)) return false;
+    if (scale == 0 || !std::isfinite(scale) || !std::isfinite(offset)) {
+        printf(ERROR "The scale of a plot's storage must be finite and not 0, its offset must be finite.\n");
+        return false;
+    }
+    if (sample_type == PLOTLIB_SAMPLE_F64 && (scale != 1 || offset != 0)) {
+        printf(ERROR "Plots which store doubles can't have a scale or an offset.\n");
+        return false;
+    }
+    return submit_to_plot(plot_idx, [=] {
+        Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+        plot_update.storage_changed = true;
+        plot_update.storage_encoding = Sample_Encoding{ sample_type, scale, offset };
+        gps_update.mark_plot_dirty(plot_idx);
+        return true;
+    });
+}
+
+PLOTAPI bool plot_set_retention_count(uint32_t plot_idx, uint64_t max_count)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit_to_plot(plot_idx, [=] {
+        Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+        plot_update.retention_changed = true;
+        plot_update.retention.max_count = max_count;
+        gps_update.mark_plot_dirty(plot_idx);
+        return true;
+    });
+}
+
+PLOTAPI bool plot_set_retention_x_range(uint32_t plot_idx, double x_range)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    if (!(x_range >= 0)) {
+        printf(ERROR "The x range a plot retains can't be negative or NaN.\n");
+        return false;
+    }
+    return submit_to_plot(plot_idx, [=] {
+        Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+        plot_update.retention_changed = true;
+        plot_update.retention.x_range = x_range;
+        gps_update.mark_plot_dirty(plot_idx);
+        return true;
+    });
+}
+
+// Compresses the values of a large plot which are no longer appended to, see 'compress_f64' and 'compress_i64'.
+// Only doubles and 64-bit integers are compressed, they are decompressed when they are shown.
+PLOTAPI bool plot_set_compression(uint32_t plot_idx, bool enabled)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit_to_plot(plot_idx, [=] {
+        Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+        plot_update.compression_changed = true;
+        plot_update.compressed = enabled;
+        gps_update.mark_plot_dirty(plot_idx);
+        return true;
+    });
+}
+
+// The numbers of the plot are shown at the x values 'x0 + i * dx' instead of at their indices 'i', which count from the first
+// number ever appended. Points with uniformly spaced x values are detected and stored like numbers, without their x values.
+PLOTAPI bool plot_set_implicit_x(uint32_t plot_idx, double x0, double dx)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    if (!std::isfinite(x0) || !(dx > 0) || !std::isfinite(dx)) {
+        printf(ERROR "The implicit x of a plot needs a finite 'x0' and a finite 'dx' larger than 0.\n");
+        return false;
+    }
+    return submit_to_plot(plot_idx, [=] {
+        Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+        plot_update.implicit_x_changed = true;
+        plot_update.implicit_x = Implicit_X{ x0, dx };
+        gps_update.mark_plot_dirty(plot_idx);
+        return true;
+    });
+}
+
+PLOTAPI bool plot_enable_append_ring(uint32_t plot_idx, uint64_t capacity)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    if (capacity == 0) {
+        printf(ERROR "The capacity of an append ring must be larger than 0.\n");
+        return false;
+    }
+    Plot_Shard& shard = gps_update.shard_of(plot_idx);
+    gps_update_mutex.lock();
+    shard.mutex.lock();
+
+    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+    bool already_has_ring = plot_update.append_ring.load(std::memory_order_relaxed) != nullptr;
+    if (!already_has_ring) {
+        plot_update.append_ring.store(new Append_Ring(capacity), std::memory_order_release);
+        gps_update.append_ring_plots.push_back(plot_idx);
+        gps_update.mark_plot_dirty(plot_idx); // initialize the plot
+    }
+
+    shard.mutex.unlock();
+    gps_update_mutex.unlock();
+
+    if (already_has_ring) {
+        printf(ERROR "The Plot with index '%d' already has an append ring.\n", plot_idx);
+        return false;
+    }
+    return true;
+}
+
+static bool valid_staging_limit(uint32_t policy, uint64_t max_staged_values)
+{
+    if (policy > PLOTLIB_STAGING_KEEP_LATEST_FILL) {
+        printf(ERROR "The staging policy '%u' is unknown.\n", policy);
+        return false;
+    }
+    if (policy != PLOTLIB_STAGING_UNBOUNDED && max_staged_values == 0) {
+        printf(ERROR "The maximum number of staged values must be larger than 0 for a bounded staging policy.\n");
+        return false;
+    }
+    return true;
+}
+
+PLOTAPI bool plotlib_set_staging_limit(uint32_t policy, uint64_t max_staged_values)
+{
+    if (!valid_staging_limit(policy, max_staged_values)) return false;
+    return submit_to_everything([=] {
+        gps_update.staging_limit = Staging_Limit{ policy, max_staged_values };
+        return true;
+    });
+}
+
+// The oldest values of large plots are moved into deleted files in 'directory' (or $TMPDIR, or /tmp, if it is NULL) once the
+// storage of all plots exceeds 'max_resident_bytes', the OS then only reads them in when they are shown. 0 keeps everything in memory.
+PLOTAPI bool plotlib_set_spill_limit(uint64_t max_resident_bytes, const char* directory)
+{
+#ifdef _WIN32
+    (void) max_resident_bytes;
+    (void) directory;
+    printf(ERROR "Spilling plots to files is only supported on POSIX systems.\n");
+    return false;
+#else
+    if (!directory) directory = getenv("TMPDIR");
+    if (!directory) directory = "/tmp";
+    struct stat directory_stat;
+    if (max_resident_bytes > 0 && (stat(directory, &directory_stat) != 0 || !S_ISDIR(directory_stat.st_mode))) {
+        printf(ERROR "The spill directory '%s' doesn't exist.\n", directory);
+        return false;
+    }
+    std::string spill_directory = directory;
+    return submit([=] {
+        gps_update.spill_limit = Spill_Limit{ max_resident_bytes, spill_directory };
+        return true;
+    });
+#endif
+}
+
+// Once the plots hold more than 'max_bytes' the gui-thread frees memory as the PLOTLIB_MEMORY_* 'policy' says. 0 is unlimited.
+PLOTAPI bool plotlib_set_memory_limit(uint64_t max_bytes, uint32_t policy)
+{
+    if (policy > PLOTLIB_MEMORY_TRIM_LARGEST) {
+        printf(ERROR "The memory policy '%u' is unknown.\n", policy);
+        return false;
+    }
+    return submit([=] {
+        gps_update.memory_limit = Memory_Limit{ max_bytes, policy };
+        return true;
+    });
+}
+
+PLOTAPI bool plot_set_staging_limit(uint32_t plot_idx, uint32_t policy, uint64_t max_staged_values)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    if (!valid_staging_limit(policy, max_staged_values)) return false;
+    return submit_to_plot(plot_idx, [=] {
+        gps_update.plot_updates[plot_idx].has_staging_limit = true;
+        gps_update.plot_updates[plot_idx].staging_limit = Staging_Limit{ policy, max_staged_values };
+        return true;
+    });
+}
+
+// Counts the values dropped by the staging limit, by a full append ring and by an overrun shared-memory ring.
+PLOTAPI uint64_t plot_get_dropped_count(uint32_t plot_idx)
+{
+    if (!valid_plot_idx(plot_idx)) return 0;
+    Plot_Shard& shard = gps_update.shard_of(plot_idx);
+    shard.mutex.lock();
+
+    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+    uint64_t dropped_count = plot_update.dropped_count;
+    Append_Ring* ring = plot_update.append_ring.load(std::memory_order_acquire);
+    if (ring) {
+        dropped_count += ring->dropped_count.load(std::memory_order_relaxed);
+    }
+    if (plot_update.shm_ring) {
+        dropped_count += plot_update.shm_ring->dropped_count.load(std::memory_order_relaxed);
+    }
 
-            // Draw plot legend
+    shard.mutex.unlock();
+    return dropped_count;
+}
 
-            float legend_content_width = 0;
-            if (gps.visible_group != DEFAULT_PLOT_GROUP_IDX) {
-                legend_content_width = rl::MeasureTextEx(gps.gui.font_large, group.label, gps.gui.fontsize_large, gps.gui.fontspacing).x;
-            }
-            for (uint64_t i = 0; i < group.plots.size(); ++i) {
-                Plot& plot = gps.plots[group.plots[i]];
-                float label_text_width = rl::MeasureTextEx(gps.gui.font_normal, plot.label, gps.gui.fontsize_normal, gps.gui.fontspacing).x;
-                legend_content_width = label_text_width > legend_content_width ? label_text_width : legend_content_width;
-            }
+// The live and capacity bytes are as of the last frame, the staged bytes are current.
+PLOTAPI bool plot_get_memory_usage(uint32_t plot_idx, plotlib_memory_usage* usage)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    Plot_Memory& plot_memory = gps_update.plot_memory[plot_idx];
+    usage->live_bytes = plot_memory.live_bytes.load(std::memory_order_relaxed);
+    usage->capacity_bytes = plot_memory.capacity_bytes.load(std::memory_order_relaxed);
+    usage->staged_bytes = plot_memory.taken_bytes.load(std::memory_order_relaxed);
 
-            float legend_x = bounds.x + bounds.width - (legend_content_width + gps.gui.offset_normal);
-            float legend_y = gps.gui.offset_normal;
-            float legend_width = legend_content_width + 2 * gps.gui.offset_normal;
+    Plot_Shard& shard = gps_update.shard_of(plot_idx);
+    shard.mutex.lock();
+    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+    usage->staged_bytes += plot_update.new_points_x.memory_size() + plot_update.new_points_y.memory_size();
+    shard.mutex.unlock();
+    return true;
+}
 
-            if (gps.visible_group != DEFAULT_PLOT_GROUP_IDX) {
-                rl::DrawTextEx(gps.gui.font_large, group.label, {legend_x, legend_y}, gps.gui.fontsize_large, gps.gui.fontspacing, gps.gui.colors.text);
-                legend_y += gps.gui.fontsize_large + gps.gui.offset_small;
-                
-                rl::DrawLineV({legend_x, legend_y}, {legend_x + legend_content_width, legend_y}, gps.gui.colors.text);
-                legend_y += gps.gui.offset_small;
-            }
+// The indices count from the oldest value the plot holds, as of the last frame.
+PLOTAPI bool plot_range_bounds(uint32_t plot_idx, uint64_t begin, uint64_t end, plotlib_bounds* bounds)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    std::lock_guard<std::mutex> plots_lock(plots_mutex);
+    Plot& plot = gps.plots[plot_idx];
+    if (begin >= end || end > plot.points_y.size()) {
+        printf(ERROR "The range [%llu, %llu) is empty or exceeds the %llu values of the plot '%u'.\n",
+               (unsigned long long) begin, (unsigned long long) end, (unsigned long long) plot.points_y.size(), plot_idx);
+        return false;
+    }
+    Range_XY bb = bounding_box_of_range(plot, begin, end);
+    *bounds = plotlib_bounds{ bb.x_begin, bb.x_end, bb.y_begin, bb.y_end };
+    return true;
+}
 
-            for (uint64_t i = 0; i < group.plots.size(); ++i) {
-                Plot& plot = gps.plots[group.plots[i]];
-                rl::DrawTextEx(gps.gui.font_normal, plot.label, {legend_x, legend_y}, gps.gui.fontsize_normal, gps.gui.fontspacing, to_rl_color(plot.color));
-                legend_y += gps.gui.fontsize_normal;
-            }
+PLOTAPI uint64_t plot_find_threshold_crossings(uint32_t plot_idx, double level, uint64_t begin, uint64_t end, uint64_t* crossings, uint64_t max_crossings)
+{
+    if (!valid_plot_idx(plot_idx)) return 0;
+    std::lock_guard<std::mutex> plots_lock(plots_mutex);
+    Plot& plot = gps.plots[plot_idx];
+    if (begin > end || end > plot.points_y.size()) {
+        printf(ERROR "The range [%llu, %llu) exceeds the %llu values of the plot '%u'.\n",
+               (unsigned long long) begin, (unsigned long long) end, (unsigned long long) plot.points_y.size(), plot_idx);
+        return 0;
+    }
+    return find_threshold_crossings(plot, level, begin, end, crossings, max_crossings);
+}
 
-            // Determine the size of the plot-screen (the part of the window where the plots should be drawn into)
+PLOTAPI bool plotlib_get_memory_usage(plotlib_memory_usage* usage)
+{
+    *usage = plotlib_memory_usage{};
+    Plot_Table<Plot_Update>& plot_updates = gps_update.plot_updates;
+    Plot_IDX plots_end = std::min(plot_updates.end(), plot_handle_end.load(std::memory_order_acquire)); // not the unused handles
+    for (Plot_IDX plot_idx = plot_updates.first(); plot_idx < plots_end; plot_idx = plot_updates.next(plot_idx)) {
+        plotlib_memory_usage plot_usage;
+        plot_get_memory_usage(plot_idx, &plot_usage);
+        usage->live_bytes += plot_usage.live_bytes;
+        usage->capacity_bytes += plot_usage.capacity_bytes;
+        usage->staged_bytes += plot_usage.staged_bytes;
+    }
+    return true;
+}
 
-            float left_plot_screen_offset = ticks.y_text_width_max + 2 * gps.gui.offset_normal;
-            if (gps.gui.zoom_resize_cooldown > 0) {
-                left_plot_screen_offset = plot_screen.x - bounds.x; // previous offset
-                gps.gui.zoom_resize_cooldown--;
-            }
-            float right_plot_screen_offset = std::max((float) MIN_PLOT_SCREEN_TO_BOUNDS_OFFSET, legend_width);
-            float top_plot_screen_offset = MIN_PLOT_SCREEN_TO_BOUNDS_OFFSET;
-            float bottom_plot_screen_offset = gps.gui.fontsize_normal + gps.gui.offset_normal;
+#ifndef _WIN32
+static std::shared_ptr<Shm_Ring> map_shm_ring(const char* shm_name, uint32_t layout)
+{
+    int fd = shm_open(shm_name, O_RDONLY, 0);
+    if (fd < 0) {
+        printf(ERROR "Failed to open the shared-memory object '%s': %s.\n", shm_name, strerror(errno));
+        return nullptr;
+    }
+    struct stat shm_stat;
+    if (fstat(fd, &shm_stat) != 0 || (uint64_t) shm_stat.st_size < sizeof(plotlib_shm_header)) {
+        printf(ERROR "The shared-memory object '%s' is too small to hold a 'plotlib_shm_header'.\n", shm_name);
+        close(fd);
+        return nullptr;
+    }
+    void* mapping = mmap(nullptr, shm_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        printf(ERROR "Failed to map the shared-memory object '%s': %s.\n", shm_name, strerror(errno));
+        return nullptr;
+    }
 
-            plot_screen = { bounds.x + left_plot_screen_offset,
-                            bounds.y + top_plot_screen_offset,
-                            bounds.width - (left_plot_screen_offset + right_plot_screen_offset),
-                            bounds.height - (top_plot_screen_offset + bottom_plot_screen_offset) };
+    std::shared_ptr<Shm_Ring> ring = std::make_shared<Shm_Ring>();
+    ring->mapping = mapping;
+    ring->mapping_size = shm_stat.st_size;
+    ring->header = (const plotlib_shm_header*) mapping;
+    ring->data = (const uint8_t*) mapping + sizeof(plotlib_shm_header);
 
-            if (plot_screen.width < 1) plot_screen.width = 1;
-            if (plot_screen.height < 1) plot_screen.height = 1;
+    const plotlib_shm_header* header = ring->header;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != PLOTLIB_SHM_MAGIC) {
+        printf(ERROR "The shared-memory object '%s' doesn't start with a 'plotlib_shm_header'.\n", shm_name);
+        return nullptr;
+    }
+    if (header->layout != layout) {
+        printf(ERROR "The shared-memory object '%s' has the layout '%u' but '%u' was expected.\n", shm_name, header->layout, layout);
+        return nullptr;
+    }
+    ring->sample_type = header->sample_type;
+    ring->sample_size = sample_type_size(header->sample_type);
+    if (ring->sample_size == 0) {
+        printf(ERROR "The sample type '%u' of the shared-memory object '%s' is unknown.\n", header->sample_type, shm_name);
+        return nullptr;
+    }
+    ring->values_per_slot = layout == PLOTLIB_LAYOUT_POINTS_XY ? 2 : 1;
+    ring->capacity = header->capacity;
+    uint64_t data_size = ring->mapping_size - sizeof(plotlib_shm_header);
+    if (ring->capacity < 2 || ring->capacity > data_size / (ring->values_per_slot * ring->sample_size)) {
+        printf(ERROR "The capacity '%llu' of the shared-memory object '%s' is less than 2 or doesn't fit into its size.\n",
+               (unsigned long long) ring->capacity, shm_name);
+        return nullptr;
+    }
 
-            auto x_to_screenspace = [=](double x) -> float {
-                return linear_map(x, plot_range.x_begin, plot_range.x_end, (double) plot_screen.x, (double) plot_screen.x + plot_screen.width);
-            };
+    // Start with everything which is still in the ring.
+    uint64_t write_cursor = ring->load_write_cursor();
+    ring->read_cursor = write_cursor > ring->capacity - 1 ? write_cursor - (ring->capacity - 1) : 0;
+    return ring;
+}
+#endif
 
-            auto y_to_screenspace = [=](double y) -> float {
-                return linear_map(y, plot_range.y_begin, plot_range.y_end, (double) plot_screen.y + plot_screen.height, (double) plot_screen.y);
-            };
+// Maps the POSIX shared-memory object 'shm_name' which starts with a 'plotlib_shm_header', the gui-thread appends the
+// samples another process writes into it to the plot every frame.
+PLOTAPI bool plot_attach_shm(uint32_t plot_idx, const char* shm_name, uint32_t layout)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+#ifdef _WIN32
+    (void) shm_name;
+    (void) layout;
+    printf(ERROR "Shared-memory rings are only supported on POSIX systems.\n");
+    return false;
+#else
+    if (layout > PLOTLIB_LAYOUT_POINTS_XY) {
+        printf(ERROR "The shared-memory layout '%u' is unknown.\n", layout);
+        return false;
+    }
+    std::shared_ptr<Shm_Ring> ring = map_shm_ring(shm_name, layout);
+    if (!ring) return false;
+
+    return submit_to_plot(plot_idx, [=] {
+        Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+        plot_update.shm_ring = ring;
+        plot_update.new_shm_ring = ring;
+        plot_update.shm_ring_changed = true;
+        gps_update.mark_plot_dirty(plot_idx);
+        return true;
+    });
+#endif
+}
 
-            // Draw plot_screen border and ticks (tick-lines and tick-labels)
+// The values which were already read stay in the plot.
+PLOTAPI bool plot_detach_shm(uint32_t plot_idx)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit_to_plot(plot_idx, [=] {
+        Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
+        if (!plot_update.shm_ring) {
+            printf(ERROR "The Plot with index '%d' isn't attached to a shared-memory ring.\n", plot_idx);
+            return false;
+        }
+        plot_update.shm_ring.reset();
+        plot_update.new_shm_ring.reset();
+        plot_update.shm_ring_changed = true;
+        gps_update.mark_plot_dirty(plot_idx);
+        return true;
+    });
+}
 
-            float bw = gps.gui.plot_screen_border_width;
-            rl::DrawRectangleLinesEx({plot_screen.x - bw, plot_screen.y - bw, plot_screen.width + 2*bw, plot_screen.height + 2*bw},
-                                     bw, gps.gui.colors.plot_screen_border);
-            
-            int tick_idx = 0;
-            for (double x = ticks.x_begin; x < plot_range.x_end; x += ticks.x_spacing, ++tick_idx) {
-                float x_screenspace = x_to_screenspace(x);
-                rl::DrawLine(x_screenspace, plot_screen.y, x_screenspace, plot_screen.y + plot_screen.height, gps.gui.colors.tick_lines);
-                rl::DrawTextEx(gps.gui.font_normal, ticks.x_text[tick_idx], {x_screenspace, plot_screen.y + plot_screen.height},
-                           gps.gui.fontsize_normal, gps.gui.fontspacing, gps.gui.colors.text);
-            }
-            
-            tick_idx = 0;
-            for (double y = ticks.y_begin; y < plot_range.y_end; y += ticks.y_spacing, ++tick_idx) {
-                float y_screenspace = y_to_screenspace(y);
-                rl::DrawLine(plot_screen.x, y_screenspace, plot_screen.x + plot_screen.width, y_screenspace, gps.gui.colors.tick_lines);
-                rl::DrawTextEx(gps.gui.font_normal, ticks.y_text[tick_idx], {bounds.x + gps.gui.offset_normal, y_screenspace - gps.gui.fontsize_normal},
-                           gps.gui.fontsize_normal, gps.gui.fontspacing, gps.gui.colors.text);
-            }
+#ifndef _WIN32
+struct Mapped_File {
+    void* address = nullptr;
+    uint64_t size = 0;
+};
 
-            // Draw in the plot-screen
-            
-            rl::BeginScissorMode(plot_screen.x, plot_screen.y, plot_screen.width, plot_screen.height);
-            {
-                // Draw x=0, y=0 coordinate-axes
-                
-                rl::DrawLineV({plot_screen.x, y_to_screenspace(0)}, {plot_screen.x + plot_screen.width, y_to_screenspace(0)}, gps.gui.colors.coordinate_axes);
-                rl::DrawLineV({x_to_screenspace(0), plot_screen.y}, {x_to_screenspace(0), plot_screen.y + plot_screen.height}, gps.gui.colors.coordinate_axes);
-            
-                // Draw the plots
-                
-                for (uint64_t i = 0; i < group.plots.size(); ++i)
-                {
-                    Plot_IDX plot_idx = group.plots[i];
-                    Plot& plot = gps.plots[plot_idx];
-                    
-                    if (plot.empty()) continue;
-                
-                    uint64_t plot_points_begin_idx = 0;
-                    if (gps.vis_mode.type == Visualization_Mode::SHOW_N_POINTS_OF_TAIL && gps.vis_mode.n_points < plot.points_y.size()) {
-                        plot_points_begin_idx = plot.points_y.size() - gps.vis_mode.n_points;
-                    }
+static void unmap_file(void* user_data)
+{
+    Mapped_File* file = (Mapped_File*) user_data;
+    munmap(file->address, file->size);
+    delete file;
+}
 
-                    if (plot.has_x_coordinate()) {
-                        float x_prev = x_to_screenspace(plot.points_x[plot_points_begin_idx]);
-                        float y_prev = y_to_screenspace(plot.points_y[plot_points_begin_idx]);
-        
-                        for (uint64_t i = plot_points_begin_idx + 1; i < plot.points_y.size(); ++i) {
-                            float x = x_to_screenspace(plot.points_x[i]);
-                            float y = y_to_screenspace(plot.points_y[i]);
-                            if (plot.show_lines) {
-                                // Plotting with width 1.0 implicitly explicitly with DrawLineV looks much worse than with DrawLineEx
-                                if (plot.line_width == 1.0)
-                                    rl::DrawLineV({x_prev, y_prev}, {x, y}, to_rl_color(plot.color));
-                                else
-                                    rl::DrawLineEx({x_prev, y_prev}, {x, y}, plot.line_width, to_rl_color(plot.color));
-                            }
-                            if (plot.show_points) {
-                                rl::DrawCircleV({x, y}, plot.point_diameter/2.0, to_rl_color(plot.color));
-                            }
-                            x_prev = x;
-                            y_prev = y;
-                        }
-                    }
-                    else {
-                        float y_prev = y_to_screenspace(plot.points_y[plot_points_begin_idx]);
-        
-                        for (uint64_t i = plot_points_begin_idx + 1; i < plot.points_y.size(); ++i) {
-                            float y = y_to_screenspace(plot.points_y[i]);
-                            if (plot.show_lines) {
-                                if (plot.line_width == 1.0)
-                                    rl::DrawLineV({x_to_screenspace(i - 1), y_prev}, {x_to_screenspace(i), y}, to_rl_color(plot.color));
-                                else
-                                    rl::DrawLineEx({x_to_screenspace(i - 1), y_prev}, {x_to_screenspace(i), y}, plot.line_width, to_rl_color(plot.color));
-                            }
-                            if (plot.show_points) {
-                                rl::DrawCircleV({x_to_screenspace(i), y}, plot.point_diameter/2.0, to_rl_color(plot.color));
-                            }
-                            y_prev = y;
-                        }
-                    }
-                }
-            }
-            rl::EndScissorMode();
+static Mapped_File* map_file(const char* path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        printf(ERROR "Failed to open the file '%s': %s.\n", path, strerror(errno));
+        return nullptr;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        printf(ERROR "The file '%s' is empty.\n", path);
+        close(fd);
+        return nullptr;
+    }
+    void* address = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        printf(ERROR "Failed to map the file '%s': %s.\n", path, strerror(errno));
+        return nullptr;
+    }
 
-            // Draw ticks marks (they have to be drawn over the plots)
+    Mapped_File* file = new Mapped_File;
+    file->address = address;
+    file->size = file_stat.st_size;
+    return file;
+}
 
-            tick_idx = 0;
-            for (double x = ticks.x_begin; x < plot_range.x_end; x += ticks.x_spacing, ++tick_idx) {
-                float x_screenspace = x_to_screenspace(x);
-                rl::DrawLineEx({x_screenspace, plot_screen.y + plot_screen.height - gps.gui.tick_mark_len}, {x_screenspace, plot_screen.y + plot_screen.height},
-                               gps.gui.plot_screen_border_width, gps.gui.colors.plot_screen_border);
-            }
-            
-            tick_idx = 0;
-            for (double y = ticks.y_begin; y < plot_range.y_end; y += ticks.y_spacing, ++tick_idx) {
-                float y_screenspace = y_to_screenspace(y);
-                rl::DrawLineEx({plot_screen.x, y_screenspace}, {plot_screen.x + gps.gui.tick_mark_len, y_screenspace},
-                               gps.gui.plot_screen_border_width, gps.gui.colors.plot_screen_border);
-            }
+// Grows 'min_value' and 'max_value' to the values. Values of a mapped file are read in chunks which are dropped from the
+// resident memory right after, their pages are read in again once they are rendered.
+static void bound_loaded_values(const double* values, uint64_t count, bool mapped, double& min_value, double& max_value)
+{
+    uint64_t chunk_length = LOAD_CHUNK_SIZE / sizeof(double);
+    for (uint64_t begin_idx = 0; begin_idx < count; begin_idx += chunk_length) {
+        uint64_t end_idx = std::min(begin_idx + chunk_length, count);
+        bound_values(values + begin_idx, end_idx - begin_idx, min_value, max_value);
+        if (mapped) {
+            uintptr_t page_size = sysconf(_SC_PAGESIZE);
+            uintptr_t first_page = (uintptr_t) &values[begin_idx] & ~(page_size - 1);
+            madvise((void*) first_page, (uintptr_t) &values[end_idx] - first_page, MADV_DONTNEED);
         }
-        rl::EndDrawing();
     }
 }
 
-static void start_gui_thread() {
-    static std::thread gui_thread(gui_loop);
-    gui_thread.detach();
-}
+// Fills the plot with the 'count' values (or points) at 'data' in the mapped file. Dense doubles are used in place, the
+// plot references the read-only file until it is cleared or filled again. Everything else is converted into memory.
+static bool fill_from_mapped_file(Plot_IDX plot_idx, Mapped_File* file, const uint8_t* data, uint32_t sample_type, uint32_t layout, uint64_t count)
+{
+    bool holds_points = layout != PLOTLIB_LAYOUT_NUMBERS;
+    const double* points_x = nullptr;
+    const double* points_y = nullptr;
+    std::shared_ptr<Borrowed_Memory> memory;
+
+    bool in_place = sample_type == PLOTLIB_SAMPLE_F64 && layout != PLOTLIB_LAYOUT_POINTS_XY && (uintptr_t) data % alignof(double) == 0;
+    if (in_place) {
+        madvise(file->address, file->size, MADV_SEQUENTIAL);
+        points_x = holds_points ? (const double*) data : nullptr;
+        points_y = holds_points ? (const double*) data + count : (const double*) data;
+        memory = std::make_shared<Borrowed_Memory>(unmap_file, file);
+    }
+    else {
+        uint64_t sample_size = sample_type_size(sample_type);
+        double* values = (double*) malloc((holds_points ? 2 : 1) * count * sizeof(double));
+        if (layout == PLOTLIB_LAYOUT_NUMBERS) {
+            convert_samples_to_double(data, sample_type, sample_size, count, values);
+        }
+        else if (layout == PLOTLIB_LAYOUT_POINTS_XY) {
+            convert_samples_to_double(data, sample_type, 2 * sample_size, count, values);
+            convert_samples_to_double(data + sample_size, sample_type, 2 * sample_size, count, values + count);
+        }
+        else {
+            convert_samples_to_double(data, sample_type, sample_size, 2 * count, values);
+        }
+        unmap_file(file);
+        points_x = holds_points ? values : nullptr;
+        points_y = holds_points ? values + count : values;
+        memory = std::make_shared<Borrowed_Memory>(free_values, values);
+    }
 
-static void start_gui_thread_if_not_started() {
-    static bool started_gui_thread = false;
-    if (!started_gui_thread) {
-        start_gui_thread();
-        started_gui_thread = true;
+    Range_XY bb = { 0, count == 0 ? 0 : (double) count - 1, MAX_PLOTRANGE_VALUE, -MAX_PLOTRANGE_VALUE };
+    if (holds_points) {
+        bb.x_begin = MAX_PLOTRANGE_VALUE;
+        bb.x_end = -MAX_PLOTRANGE_VALUE;
+        bound_loaded_values(points_x, count, in_place, bb.x_begin, bb.x_end);
     }
+    bound_loaded_values(points_y, count, in_place, bb.y_begin, bb.y_end);
+
+    return submit_to_plot(plot_idx, [=] {
+        bool success = holds_points
+            ? stage_points(plot_idx, points_x, sizeof(double), points_y, sizeof(double), PLOTLIB_SAMPLE_F64, count, true, memory)
+            : stage_numbers(plot_idx, points_y, PLOTLIB_SAMPLE_F64, sizeof(double), count, true, memory);
+        if (success) {
+            gps_update.plot_updates[plot_idx].bounding_box = bb;
+            gps_update.plot_updates[plot_idx].bounded_length = count;
+        }
+        return success;
+    });
 }
 
-PLOTAPI void plotlib_show()
+// Reads the little-endian sample type of a .npy 'descr' like '<f8'.
+static uint32_t npy_sample_type(const char* descr)
 {
-    gps_update_mutex.lock();
-    gps_update.window_visible = true;
-    start_gui_thread_if_not_started();
-    gps_update_mutex.unlock();
+    if (descr[0] != '<' && descr[0] != '|' && descr[0] != '=') return INVALID_IDX;
+    if (strncmp(descr + 1, "f8'", 3) == 0) return PLOTLIB_SAMPLE_F64;
+    if (strncmp(descr + 1, "f4'", 3) == 0) return PLOTLIB_SAMPLE_F32;
+    if (strncmp(descr + 1, "i4'", 3) == 0) return PLOTLIB_SAMPLE_I32;
+    if (strncmp(descr + 1, "i2'", 3) == 0) return PLOTLIB_SAMPLE_I16;
+    if (strncmp(descr + 1, "u2'", 3) == 0) return PLOTLIB_SAMPLE_U16;
+    if (strncmp(descr + 1, "i8'", 3) == 0) return PLOTLIB_SAMPLE_I64;
+    return INVALID_IDX;
 }
 
-PLOTAPI void plotlib_hide()
+// Finds the array in a .npy file. One dimensional arrays are numbers, two dimensional arrays with one dimension of
+// length 2 are points.
+static bool parse_npy_header(const char* path, const uint8_t* file, uint64_t file_size, uint64_t& data_offset,
+                             uint32_t& sample_type, uint32_t& layout, uint64_t& count)
 {
-    gps_update_mutex.lock();
-    gps_update.terminate = true;
-    gps_update_mutex.unlock();
+    if (file_size < 10 || memcmp(file, "\x93NUMPY", 6) != 0) {
+        printf(ERROR "The file '%s' is not a .npy file.\n", path);
+        return false;
+    }
+    uint64_t header_offset = file[6] == 1 ? 10 : 12;
+    if (file[6] > 3 || file_size < header_offset) {
+        printf(ERROR "The .npy file '%s' has the unsupported version %d.\n", path, file[6]);
+        return false;
+    }
+    uint64_t header_length = file[8] | file[9] << 8;
+    if (header_offset == 12) {
+        header_length |= (uint64_t) file[10] << 16 | (uint64_t) file[11] << 24;
+    }
+    if (header_offset + header_length > file_size) {
+        printf(ERROR "The header of the .npy file '%s' is truncated.\n", path);
+        return false;
+    }
+    std::vector<char> header(header_length + 1, '\0');
+    memcpy(header.data(), file + header_offset, header_length);
+
+    const char* descr = strstr(header.data(), "'descr':");
+    const char* fortran_order = strstr(header.data(), "'fortran_order':");
+    const char* shape = strstr(header.data(), "'shape':");
+    if (!descr || !fortran_order || !shape || !(descr = strchr(descr + 8, '\'')) || !(shape = strchr(shape, '('))) {
+        printf(ERROR "The header of the .npy file '%s' is malformed.\n", path);
+        return false;
+    }
+    sample_type = npy_sample_type(descr + 1);
+    if (sample_type == INVALID_IDX) {
+        printf(ERROR "The .npy file '%s' holds an unsupported data type, supported are f8, f4, i8, i4, i2 and u2 in little-endian.\n", path);
+        return false;
+    }
+    fortran_order += 16;
+    while (*fortran_order == ' ') ++fortran_order;
+    bool is_fortran_order = strncmp(fortran_order, "True", 4) == 0;
+
+    uint64_t dims[3];
+    int dim_count = 0;
+    for (const char* c = shape + 1; *c && *c != ')' && dim_count < 3;) {
+        char* end;
+        uint64_t dim = strtoull(c, &end, 10);
+        if (end == c) break;
+        dims[dim_count++] = dim;
+        c = end;
+        while (*c == ',' || *c == ' ') ++c;
+    }
+
+    if (dim_count == 1) {
+        layout = PLOTLIB_LAYOUT_NUMBERS;
+        count = dims[0];
+    }
+    else if (dim_count == 2 && dims[1] == 2) {
+        layout = is_fortran_order ? PLOTLIB_LAYOUT_POINTS_X_Y : PLOTLIB_LAYOUT_POINTS_XY;
+        count = dims[0];
+    }
+    else if (dim_count == 2 && dims[0] == 2) {
+        layout = is_fortran_order ? PLOTLIB_LAYOUT_POINTS_XY : PLOTLIB_LAYOUT_POINTS_X_Y;
+        count = dims[1];
+    }
+    else {
+        printf(ERROR "The .npy file '%s' must hold a one dimensional array or a two dimensional array of points.\n", path);
+        return false;
+    }
+
+    data_offset = header_offset + header_length;
+    uint64_t values_per_sample = layout == PLOTLIB_LAYOUT_NUMBERS ? 1 : 2;
+    if (count > (file_size - data_offset) / (values_per_sample * sample_type_size(sample_type))) {
+        printf(ERROR "The .npy file '%s' is smaller than the shape in its header.\n", path);
+        return false;
+    }
+    return true;
 }
+#endif
 
-PLOTAPI void plotlib_dark_theme()
+// Fills the plot with the array in the .npy file. The file is mapped instead of read, see 'plot_load_raw'.
+PLOTAPI bool plot_load_npy(uint32_t plot_idx, const char* path)
 {
-    gps_update_mutex.lock();
-    gps_update.theme_colors = dark_theme_colors;
-    gps_update_mutex.unlock();
+    if (!valid_plot_idx(plot_idx)) return false;
+#ifdef _WIN32
+    (void) path;
+    printf(ERROR "Loading mapped files is only supported on POSIX systems.\n");
+    return false;
+#else
+    Mapped_File* file = map_file(path);
+    if (!file) return false;
+
+    uint64_t data_offset, count;
+    uint32_t sample_type, layout;
+    if (!parse_npy_header(path, (const uint8_t*) file->address, file->size, data_offset, sample_type, layout, count)) {
+        unmap_file(file);
+        return false;
+    }
+    return fill_from_mapped_file(plot_idx, file, (const uint8_t*) file->address + data_offset, sample_type, layout, count);
+#endif
 }
 
-PLOTAPI void plotlib_light_theme()
+// Fills the plot with a file which only contains samples of 'sample_type' in 'layout'. The file is mapped instead of read.
+// Float64 numbers, or float64 points in PLOTLIB_LAYOUT_POINTS_X_Y, are shown straight from the file, which is only read
+// once to compute the bounding box and then read in again as far as it is rendered. Other files are converted into memory.
+PLOTAPI bool plot_load_raw(uint32_t plot_idx, const char* path, uint32_t sample_type, uint32_t layout)
 {
-    gps_update_mutex.lock();
-    gps_update.theme_colors = light_theme_colors;
-    gps_update_mutex.unlock();
+    if (!valid_plot_idx(plot_idx)) return false;
+#ifdef _WIN32
+    (void) path;
+    (void) sample_type;
+    (void) layout;
+    printf(ERROR "Loading mapped files is only supported on POSIX systems.\n");
+    return false;
+#else
+    uint64_t sample_size = sample_type_size(sample_type);
+    if (sample_size == 0) {
+        printf(ERROR "The sample type '%u' is unknown.\n", sample_type);
+        return false;
+    }
+    if (layout > PLOTLIB_LAYOUT_POINTS_X_Y) {
+        printf(ERROR "The layout '%u' is unknown.\n", layout);
+        return false;
+    }
+    Mapped_File* file = map_file(path);
+    if (!file) return false;
+
+    uint64_t values_per_sample = layout == PLOTLIB_LAYOUT_NUMBERS ? 1 : 2;
+    if (file->size % (values_per_sample * sample_size) != 0) {
+        printf(ERROR "The size of the file '%s' is not a multiple of the size of its %s.\n", path, values_per_sample == 1 ? "samples" : "points");
+        unmap_file(file);
+        return false;
+    }
+    uint64_t count = file->size / (values_per_sample * sample_size);
+    return fill_from_mapped_file(plot_idx, file, (const uint8_t*) file->address, sample_type, layout, count);
+#endif
 }
 
-PLOTAPI void plotlib_mode_interactive()
+#ifndef _WIN32
+// A part of a CSV file which starts and ends on a line boundary, it is parsed by its own thread.
+struct Csv_Chunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    uint64_t first_row = 0;
+    uint64_t row_count = 0;
+    std::vector<double> min_values; // per loaded column
+    std::vector<double> max_values;
+    uint64_t malformed_count = 0;
+};
+
+// Empty lines aren't rows.
+static bool is_csv_row(const char* line, const char* line_end)
 {
-    gps_update_mutex.lock();
-    gps_update.vis_mode = Visualization_Mode { .type=Visualization_Mode::INTERACTIVE };
-    gps_update_mutex.unlock();
+    return line_end > line && !(line_end - line == 1 && *line == '\r');
 }
 
-PLOTAPI void plotlib_mode_show_n_points_of_tail(uint64_t points_count)
+static void count_csv_rows(Csv_Chunk& chunk)
 {
-    gps_update_mutex.lock();
-    gps_update.vis_mode = Visualization_Mode { .type=Visualization_Mode::SHOW_N_POINTS_OF_TAIL, .n_points=points_count };
-    gps_update_mutex.unlock();
+    for (const char* line = chunk.begin; line < chunk.end;) {
+        const char* line_end = (const char*) memchr(line, '\n', chunk.end - line);
+        if (!line_end) line_end = chunk.end;
+        chunk.row_count += is_csv_row(line, line_end);
+        line = line_end + 1;
+    }
 }
 
-PLOTAPI void plotlib_mode_show_x_range_of_tail(double x_range)
+// Parses the field at 'c' and moves 'c' behind its delimiter. Empty fields are NaN, returns false if the field holds
+// something else than a number.
+static bool parse_csv_field(const char*& c, const char* line_end, double& value)
 {
-    gps_update_mutex.lock();
-    gps_update.vis_mode = Visualization_Mode { .type=Visualization_Mode::SHOW_X_RANGE_OF_TAIL, .x_range=x_range };
-    gps_update_mutex.unlock();
+    while (c < line_end && *c == ' ') ++c;
+    const char* number = c < line_end && *c == '+' ? c + 1 : c;
+    std::from_chars_result result = std::from_chars(number, line_end, value);
+    bool parsed = result.ec == std::errc();
+    bool empty = c == line_end || *c == ',' || *c == ';' || *c == '\t';
+    if (parsed) c = result.ptr;
+
+    while (c < line_end && *c != ',' && *c != ';' && *c != '\t') ++c;
+    if (c < line_end) ++c;
+
+    if (!parsed) value = std::numeric_limits<double>::quiet_NaN();
+    return parsed || empty;
 }
 
-PLOTAPI void plotlib_mode_fill_window()
+// Parses the rows of the chunk straight into 'columns', where loaded column 'slot' starts at 'columns + slot * row_count'.
+static void parse_csv_chunk(Csv_Chunk& chunk, const std::vector<uint32_t>& column_slots, double* columns, uint64_t row_count)
 {
-    gps_update_mutex.lock();
-    gps_update.vis_mode = Visualization_Mode { .type=Visualization_Mode::SHOW_ENTIRE_PLOT_GROUP };
-    gps_update_mutex.unlock();
+    uint64_t row = chunk.first_row;
+    for (const char* line = chunk.begin; line < chunk.end;) {
+        const char* line_end = (const char*) memchr(line, '\n', chunk.end - line);
+        const char* next_line = line_end ? line_end + 1 : chunk.end;
+        if (!line_end) line_end = chunk.end;
+        if (!is_csv_row(line, line_end)) {
+            line = next_line;
+            continue;
+        }
+        if (line_end[-1] == '\r') --line_end;
+
+        const char* c = line;
+        for (size_t column = 0; column < column_slots.size(); ++column) {
+            double value;
+            bool valid = parse_csv_field(c, line_end, value);
+            uint32_t slot = column_slots[column];
+            if (slot == INVALID_IDX) continue;
+
+            chunk.malformed_count += !valid;
+            columns[slot * row_count + row] = value;
+            chunk.min_values[slot] = value < chunk.min_values[slot] ? value : chunk.min_values[slot];
+            chunk.max_values[slot] = value > chunk.max_values[slot] ? value : chunk.max_values[slot];
+        }
+        ++row;
+        line = next_line;
+    }
 }
 
-PLOTAPI bool plotlib_mode_show_specific_plot(uint32_t plot_idx)
+// The first line is a header if its first field isn't a number.
+static const char* skip_csv_header(const char* begin, const char* end)
 {
-    if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-    gps_update.vis_mode = Visualization_Mode { .type=Visualization_Mode::SHOW_SPECIFIC_PLOT, .specific_plot=plot_idx };
-    gps_update_mutex.unlock();
-    return true;
+    const char* line_end = (const char*) memchr(begin, '\n', end - begin);
+    if (!line_end) line_end = end;
+    const char* c = begin;
+    double value;
+    return parse_csv_field(c, line_end, value) ? begin : std::min(line_end + 1, end);
 }
+#endif
 
-PLOTAPI void plotlib_clear_all_plots()
+// Loads the columns of a CSV file into the plots, 'column_plots[column]' is the plot of the column or PLOTLIB_NO_IDX to
+// skip it. If 'x_column' isn't PLOTLIB_NO_IDX, its values are the x coordinates of all loaded columns, otherwise they are
+// loaded as numbers. The file is parsed by all cores in parallel, fields which aren't numbers are loaded as NaN.
+PLOTAPI bool plotlib_load_csv(const char* path, const uint32_t* column_plots, uint32_t column_count, uint32_t x_column)
 {
-    gps_update_mutex.lock();
-    
-    for (Plot_IDX plot_idx = 0; plot_idx < MAX_PLOT_SIZE; ++plot_idx) {
-        gps_update.plot_updates[plot_idx].clear_plot();
+#ifdef _WIN32
+    (void) path;
+    (void) column_plots;
+    (void) column_count;
+    (void) x_column;
+    printf(ERROR "Loading mapped files is only supported on POSIX systems.\n");
+    return false;
+#else
+    if (x_column != PLOTLIB_NO_IDX && x_column >= column_count) {
+        printf(ERROR "The x column '%u' is not one of the %u columns.\n", x_column, column_count);
+        return false;
     }
-    for (Group_IDX group_idx = 0; group_idx < MAX_PLOT_GROUP_SIZE; ++group_idx) {
-        gps_update.plot_group_updates[group_idx].clear_group();
+
+    // The x column gets the first slot, then every column which goes into a plot.
+    std::vector<uint32_t> column_slots(column_count, INVALID_IDX);
+    std::vector<Plot_IDX> slot_plots;
+    if (x_column != PLOTLIB_NO_IDX) {
+        column_slots[x_column] = 0;
+        slot_plots.push_back(INVALID_IDX);
+    }
+    for (uint32_t column = 0; column < column_count; ++column) {
+        if (column == x_column || column_plots[column] == PLOTLIB_NO_IDX) continue;
+        if (!valid_plot_idx(column_plots[column])) return false;
+        column_slots[column] = slot_plots.size();
+        slot_plots.push_back(column_plots[column]);
+    }
+    if (slot_plots.size() == (x_column != PLOTLIB_NO_IDX ? 1u : 0u)) {
+        printf(ERROR "No column of the CSV file '%s' is loaded into a plot.\n", path);
+        return false;
     }
-    
-    gps_update_mutex.unlock();    
-}
 
-PLOTAPI bool plot_show(Plot_IDX plot_idx)
-{
-    if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
+    Mapped_File* file = map_file(path);
+    if (!file) return false;
+    madvise(file->address, file->size, MADV_SEQUENTIAL);
+    const char* begin = skip_csv_header((const char*) file->address, (const char*) file->address + file->size);
+    const char* end = (const char*) file->address + file->size;
+
+    uint64_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+    thread_count = std::min(thread_count, (uint64_t) (end - begin) / MIN_CSV_CHUNK_SIZE + 1);
+
+    std::vector<Csv_Chunk> chunks(thread_count);
+    for (uint64_t i = 0; i < thread_count; ++i) {
+        chunks[i].begin = i == 0 ? begin : chunks[i - 1].end;
+        chunks[i].end = begin + (end - begin) * (i + 1) / thread_count;
+        if (chunks[i].end < chunks[i].begin) chunks[i].end = chunks[i].begin;
+        const char* line_end = (const char*) memchr(chunks[i].end, '\n', end - chunks[i].end);
+        chunks[i].end = line_end ? line_end + 1 : end;
+        chunks[i].min_values.assign(slot_plots.size(), MAX_PLOTRANGE_VALUE);
+        chunks[i].max_values.assign(slot_plots.size(), -MAX_PLOTRANGE_VALUE);
+    }
 
-    Plot_Group_Update& group_update = gps_update.plot_group_updates[DEFAULT_PLOT_GROUP_IDX];
+    // The rows are counted first, so every thread knows where its rows go.
+    std::vector<std::thread> threads;
+    for (uint64_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(count_csv_rows, std::ref(chunks[i]));
+    }
+    count_csv_rows(chunks[0]);
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    threads.clear();
 
-    if (gps_update.visible_group != DEFAULT_PLOT_GROUP_IDX) {
-        group_update.clear_group();
+    uint64_t row_count = 0;
+    for (uint64_t i = 0; i < thread_count; ++i) {
+        chunks[i].first_row = row_count;
+        row_count += chunks[i].row_count;
     }
 
-    group_update.new_plots.push_back(plot_idx);
-    group_update.empty_update = false;
-    gps_update.plot_updates[plot_idx].empty_update = false; // initialize the plot
-    gps_update.visible_group = DEFAULT_PLOT_GROUP_IDX;
-    gps_update.window_visible = true;
-            
-    gps_update_mutex.unlock();
-    start_gui_thread_if_not_started();
-    return true;
+    double* columns = (double*) malloc(std::max<uint64_t>(1, slot_plots.size() * row_count) * sizeof(double));
+    for (uint64_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(parse_csv_chunk, std::ref(chunks[i]), std::cref(column_slots), columns, row_count);
+    }
+    parse_csv_chunk(chunks[0], column_slots, columns, row_count);
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    unmap_file(file);
+
+    uint64_t malformed_count = 0;
+    std::vector<Range_XY> bounding_boxes(slot_plots.size(), Range_XY{ 0, row_count == 0 ? 0 : (double) row_count - 1, 0, 0 });
+    for (size_t slot = 0; slot < slot_plots.size(); ++slot) {
+        bounding_boxes[slot].y_begin = MAX_PLOTRANGE_VALUE;
+        bounding_boxes[slot].y_end = -MAX_PLOTRANGE_VALUE;
+        for (uint64_t i = 0; i < thread_count; ++i) {
+            bounding_boxes[slot].y_begin = std::min(bounding_boxes[slot].y_begin, chunks[i].min_values[slot]);
+            bounding_boxes[slot].y_end = std::max(bounding_boxes[slot].y_end, chunks[i].max_values[slot]);
+        }
+    }
+    for (uint64_t i = 0; i < thread_count; ++i) {
+        malformed_count += chunks[i].malformed_count;
+    }
+    if (malformed_count > 0) {
+        printf(WARNING "%llu fields of the CSV file '%s' are not numbers, they were loaded as NaN.\n", (unsigned long long) malformed_count, path);
+    }
+
+    // All plots reference the parsed columns, they are freed once no plot shows them anymore.
+    std::shared_ptr<Borrowed_Memory> memory = std::make_shared<Borrowed_Memory>(free_values, columns);
+    bool has_x = x_column != PLOTLIB_NO_IDX;
+    return submit_to_everything([=] {
+        bool success = true;
+        for (size_t slot = has_x ? 1 : 0; slot < slot_plots.size(); ++slot) {
+            Plot_IDX plot_idx = slot_plots[slot];
+            const double* points_y = columns + slot * row_count;
+            Range_XY bb = bounding_boxes[slot];
+            bool staged = false;
+            if (has_x) {
+                staged = stage_points(plot_idx, columns, sizeof(double), points_y, sizeof(double), PLOTLIB_SAMPLE_F64, row_count, true,
+                                      memory);
+                bb.x_begin = bounding_boxes[0].y_begin;
+                bb.x_end = bounding_boxes[0].y_end;
+            }
+            else {
+                staged = stage_numbers(plot_idx, points_y, PLOTLIB_SAMPLE_F64, sizeof(double), row_count, true, memory);
+            }
+            if (staged) {
+                gps_update.plot_updates[plot_idx].bounding_box = bb;
+                gps_update.plot_updates[plot_idx].bounded_length = row_count;
+            }
+            success &= staged;
+        }
+        return success;
+    });
+#endif
 }
 
-PLOTAPI bool plot_as_lines(uint32_t plot_idx, double line_width)
+PLOTAPI uint64_t plotlib_get_dropped_count()
 {
-    if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-
-    gps_update.plot_updates[plot_idx].show_lines = true;
-    gps_update.plot_updates[plot_idx].show_points = false;
-    gps_update.plot_updates[plot_idx].line_width = line_width;
-    gps_update.plot_updates[plot_idx].empty_update = false;
-    
-    gps_update_mutex.unlock();
-    return true;
+    uint64_t dropped_count = 0;
+    Plot_Table<Plot_Update>& plot_updates = gps_update.plot_updates;
+    Plot_IDX plots_end = std::min(plot_updates.end(), plot_handle_end.load(std::memory_order_acquire)); // not the unused handles
+    for (Plot_IDX plot_idx = plot_updates.first(); plot_idx < plots_end; plot_idx = plot_updates.next(plot_idx)) {
+        dropped_count += plot_get_dropped_count(plot_idx);
+    }
+    return dropped_count;
 }
 
-PLOTAPI bool plot_as_scatter(uint32_t plot_idx, double diameter)
+PLOTAPI bool plot_append_number(uint32_t plot_idx, double number)
 {
     if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-
-    gps_update.plot_updates[plot_idx].show_points = true;
-    gps_update.plot_updates[plot_idx].show_lines = false;
-    gps_update.plot_updates[plot_idx].point_diameter = diameter;
-    gps_update.plot_updates[plot_idx].empty_update = false;
-    
-    gps_update_mutex.unlock();
-    return true;
+    return submit_numbers(plot_idx, &number, PLOTLIB_SAMPLE_F64, sizeof(double), 1, false, nullptr);
 }
 
-PLOTAPI bool plot_as_scatterlines(uint32_t plot_idx, double line_width, double diameter)
+PLOTAPI bool plot_append_numbers(uint32_t plot_idx, double* numbers, uint64_t length)
 {
     if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-
-    gps_update.plot_updates[plot_idx].show_points = true;
-    gps_update.plot_updates[plot_idx].show_lines = true;
-    gps_update.plot_updates[plot_idx].line_width = line_width;
-    gps_update.plot_updates[plot_idx].point_diameter = diameter;
-
-    gps_update.plot_updates[plot_idx].empty_update = false;
-    
-    gps_update_mutex.unlock();
-    return true;
+    return submit_numbers(plot_idx, numbers, PLOTLIB_SAMPLE_F64, sizeof(double), length, false, nullptr);
 }
 
-PLOTAPI bool plot_hide(Plot_IDX plot_idx)
+PLOTAPI bool plot_append_point(uint32_t plot_idx, double point_x, double point_y)
 {
     if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
+    return submit_points(plot_idx, &point_x, sizeof(double), &point_y, sizeof(double), PLOTLIB_SAMPLE_F64, 1, false, nullptr);
+}
 
-    Plot_Group_Update& group_update = gps_update.plot_group_updates[DEFAULT_PLOT_GROUP_IDX];
+PLOTAPI bool plot_append_points_x_y(uint32_t plot_idx, double* points_x, double* points_y, uint64_t length)
+{
+    if (!valid_plot_idx(plot_idx)) return false;
+    return submit_points(plot_idx, points_x, sizeof(double), points_y, sizeof(double), PLOTLIB_SAMPLE_F64, length, false, nullptr);
+}
 
-    group_update.remove_plots.push_back(plot_idx);
-    group_update.empty_update = false;
-            
-    gps_update_mutex.unlock();
-    return true;
+PLOTAPI bool plot_append_numbers_typed(uint32_t plot_idx, const void* numbers, uint32_t sample_type, uint64_t length)
+{
+    if (!valid_plot_idx(plot_idx) || !valid_sample_type(sample_type)) return false;
+    return submit_numbers(plot_idx, numbers, sample_type, sample_type_size(sample_type), length, false, nullptr);
 }
 
-PLOTAPI void plot_hide_all()
+PLOTAPI bool plot_append_points_x_y_typed(uint32_t plot_idx, const void* points_x, const void* points_y, uint32_t sample_type, uint64_t length)
 {
-    gps_update_mutex.lock();
+    if (!valid_plot_idx(plot_idx) || !valid_sample_type(sample_type)) return false;
+    uint64_t stride = sample_type_size(sample_type);
+    return submit_points(plot_idx, points_x, stride, points_y, stride, sample_type, length, false, nullptr);
+}
 
-    Plot_Group_Update& group_update = gps_update.plot_group_updates[DEFAULT_PLOT_GROUP_IDX];
+PLOTAPI bool plot_append_numbers_strided(uint32_t plot_idx, const void* numbers, uint64_t stride, uint32_t sample_type, uint64_t length)
+{
+    if (!valid_plot_idx(plot_idx) || !valid_sample_type(sample_type)) return false;
+    return submit_numbers(plot_idx, numbers, sample_type, stride, length, false, nullptr);
+}
 
-    group_update.clear_group();
-    group_update.empty_update = false;
-            
-    gps_update_mutex.unlock();
+PLOTAPI bool plot_append_points_strided(uint32_t plot_idx, const void* points_x, uint64_t x_stride, const void* points_y, uint64_t y_stride,
+                                        uint32_t sample_type, uint64_t length)
+{
+    if (!valid_plot_idx(plot_idx) || !valid_sample_type(sample_type)) return false;
+    return submit_points(plot_idx, points_x, x_stride, points_y, y_stride, sample_type, length, false, nullptr);
 }
 
-PLOTAPI bool plot_clear(uint32_t plot_idx)
+PLOTAPI bool plot_append_timestamped(uint32_t plot_idx, const int64_t* timestamps_ns, const double* values, uint64_t length)
 {
     if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-
-    gps_update.plot_updates[plot_idx].clear_plot();
-
-    gps_update_mutex.unlock();
-    return true;
+    return submit_timestamped(plot_idx, timestamps_ns, values, length, false);
 }
 
-PLOTAPI bool plot_set_color(uint32_t plot_idx, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+PLOTAPI bool plot_append_points_xy(uint32_t plot_idx, double* points_xy, uint64_t length)
 {
     if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-
-    gps_update.plot_updates[plot_idx].custom_color = Color{r, g, b, a};
-    gps_update.plot_updates[plot_idx].has_custom_color = true;
-    gps_update.plot_updates[plot_idx].empty_update = false;
-
-    gps_update_mutex.unlock();
-    return true;
+    if (length % 2 != 0) {
+        printf(ERROR "The length provided is not divisible by 2 but 'plot_append_points_xy' expects an array of Points.\n");
+        return false;
+    }
+    return submit_points(plot_idx, points_xy, 2 * sizeof(double), points_xy + 1, 2 * sizeof(double), PLOTLIB_SAMPLE_F64, length / 2,
+                         false, nullptr);
 }
 
-PLOTAPI bool plot_set_name(uint32_t plot_idx, const char* name)
+// The borrowed variants take 'release' instead of copying the values. It is called exactly once, from any thread, as soon as
+// plotlib doesn't read the values anymore (also if the call fails) and it must not call back into plotlib.
+
+PLOTAPI bool plot_fill_numbers_borrowed(uint32_t plot_idx, const double* numbers, uint64_t length, plotlib_release_fn release, void* user_data)
 {
+    std::shared_ptr<Borrowed_Memory> memory = std::make_shared<Borrowed_Memory>(release, user_data);
     if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-    
-    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
-    
-    plot_update.new_name = new char[strlen(name) + 1];
-    strcpy(plot_update.new_name, name);
-    plot_update.empty_update = false;
-
-    gps_update_mutex.unlock();
-    return true;
+    return submit_numbers(plot_idx, numbers, PLOTLIB_SAMPLE_F64, sizeof(double), length, true, memory);
 }
 
-PLOTAPI bool plot_fill_numbers(uint32_t plot_idx, double* numbers, uint64_t length)
+PLOTAPI bool plot_fill_points_x_y_borrowed(uint32_t plot_idx, const double* points_x, const double* points_y, uint64_t length,
+                                           plotlib_release_fn release, void* user_data)
 {
+    std::shared_ptr<Borrowed_Memory> memory = std::make_shared<Borrowed_Memory>(release, user_data);
     if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-    
-    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
-    plot_update.clear_plot();
-    
-    plot_update.new_points_y.resize(length);
-    for (uint64_t i = 0; i < length; ++i) {
-        plot_update.new_points_y[i] = numbers[i];
-    }
-    plot_update.contains_numbers = true;
-    plot_update.empty_update = false;
-
-    gps_update_mutex.unlock();
-    return true;
+    return submit_points(plot_idx, points_x, sizeof(double), points_y, sizeof(double), PLOTLIB_SAMPLE_F64, length, true, memory);
 }
 
-PLOTAPI bool plot_fill_points_x_y(uint32_t plot_idx, double* points_x, double* points_y, uint64_t length)
+PLOTAPI bool plot_append_numbers_borrowed(uint32_t plot_idx, const double* numbers, uint64_t length, plotlib_release_fn release, void* user_data)
 {
+    std::shared_ptr<Borrowed_Memory> memory = std::make_shared<Borrowed_Memory>(release, user_data);
     if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-
-    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
-    plot_update.clear_plot();
-
-    plot_update.new_points_x.resize(length);
-    plot_update.new_points_y.resize(length);
-    for (uint64_t i = 0; i < length; ++i) {
-        plot_update.new_points_x[i] = points_x[i];
-        plot_update.new_points_y[i] = points_y[i];
-    }
-    plot_update.contains_points = true;
-    plot_update.empty_update = false;
-
-    gps_update_mutex.unlock();
-    return true;    
+    return submit_numbers(plot_idx, numbers, PLOTLIB_SAMPLE_F64, sizeof(double), length, false, memory);
 }
 
-PLOTAPI bool plot_fill_points_xy(uint32_t plot_idx, double* points_xy, uint64_t length)
+PLOTAPI bool plot_append_points_x_y_borrowed(uint32_t plot_idx, const double* points_x, const double* points_y, uint64_t length,
+                                             plotlib_release_fn release, void* user_data)
 {
+    std::shared_ptr<Borrowed_Memory> memory = std::make_shared<Borrowed_Memory>(release, user_data);
     if (!valid_plot_idx(plot_idx)) return false;
-    if (length % 2 != 0) {
-        printf(ERROR "The length provided is not divisible by 2 but 'plot_fill_points_xy' expects an array of Points.\n");
-        return false;
-    }
-    gps_update_mutex.lock();
+    return submit_points(plot_idx, points_x, sizeof(double), points_y, sizeof(double), PLOTLIB_SAMPLE_F64, length, false, memory);
+}
 
-    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
-    plot_update.clear_plot();
+#ifndef _WIN32
+struct Stream_Connection {
+    int fd = -1;
+    std::vector<uint8_t> received;
+    uint64_t received_length = 0; // bytes of frames which weren't complete yet
+};
 
-    plot_update.new_points_x.resize(length / 2);
-    plot_update.new_points_y.resize(length / 2);
-    for (uint64_t i = 0; i < length / 2; ++i) {
-        plot_update.new_points_x[i] = points_xy[i * 2];
-        plot_update.new_points_y[i] = points_xy[i * 2 + 1];
-    }
-    plot_update.contains_points = true;
-    plot_update.empty_update = false;
+// Listens on a Unix domain socket and stages the frames of every connected process, see 'plotlib_frame_header'. Frames are
+// staged as they arrive, so the gui-thread picks up everything received since the last frame at once.
+struct Stream_Server {
+    std::thread thread;
+    int listen_fd = -1;
+    int wake_pipe[2] = { -1, -1 }; // written to stop the server
+    char* socket_path = nullptr;
+    std::vector<Stream_Connection> connections;
+};
 
-    gps_update_mutex.unlock();
-    return true;    
-}
+static std::mutex stream_server_mutex; // guards starting and stopping the server
+static Stream_Server* stream_server = nullptr;
 
-PLOTAPI bool plot_append_number(uint32_t plot_idx, double number)
+static void stage_frame(const plotlib_frame_header& header, const uint8_t* payload)
 {
-    if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-    
-    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
-    if (plot_update.contains_points) {
-        printf(ERROR "The Plot with index '%d' contains points and cannot be appended with the number '%f'.\n", plot_idx, number);
-        gps_update_mutex.unlock();
-        return false;
+    if (!valid_plot_idx(header.plot_idx)) return; // only this frame is skipped, the stream is still intact
+    uint64_t sample_size = sample_type_size(header.sample_type);
+
+    switch (header.command) {
+    case PLOTLIB_FRAME_APPEND_NUMBERS:
+        submit_numbers(header.plot_idx, payload, header.sample_type, sample_size, header.count, false, nullptr);
+        break;
+    case PLOTLIB_FRAME_APPEND_POINTS:
+        submit_points(header.plot_idx, payload, 2 * sample_size, payload + sample_size, 2 * sample_size, header.sample_type, header.count, false, nullptr);
+        break;
+    case PLOTLIB_FRAME_FILL_NUMBERS:
+        submit_numbers(header.plot_idx, payload, header.sample_type, sample_size, header.count, true, nullptr);
+        break;
+    case PLOTLIB_FRAME_FILL_POINTS:
+        submit_points(header.plot_idx, payload, 2 * sample_size, payload + sample_size, 2 * sample_size, header.sample_type, header.count, true, nullptr);
+        break;
     }
-    
-    plot_update.new_points_y.push_back(number);
-    plot_update.contains_numbers = true;
-    plot_update.empty_update = false;
-
-    gps_update_mutex.unlock();
-    return true;    
 }
 
-PLOTAPI bool plot_append_numbers(uint32_t plot_idx, double* numbers, uint64_t length)
+// Reads what the connection has sent and stages every complete frame. Returns false once the connection has to be closed.
+static bool receive_frames(Stream_Connection& connection)
 {
-    if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-    
-    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
-    if (plot_update.contains_points) {
-        printf(ERROR "The Plot with index '%d' contains points and cannot be appended with numbers.\n", plot_idx);
-        gps_update_mutex.unlock();
+    if (connection.received.size() < connection.received_length + STREAM_RECEIVE_SIZE) {
+        connection.received.resize(connection.received_length + STREAM_RECEIVE_SIZE);
+    }
+    ssize_t read_size = read(connection.fd, &connection.received[connection.received_length], STREAM_RECEIVE_SIZE);
+    if (read_size < 0 && errno == EINTR) return true;
+    if (read_size <= 0) {
+        if (connection.received_length > 0) {
+            printf(WARNING "A streaming connection was closed in the middle of a frame, its last %llu bytes were dropped.\n",
+                   (unsigned long long) connection.received_length);
+        }
         return false;
     }
+    connection.received_length += read_size;
+
+    uint64_t offset = 0;
+    while (connection.received_length - offset >= sizeof(plotlib_frame_header)) {
+        plotlib_frame_header header;
+        memcpy(&header, &connection.received[offset], sizeof(plotlib_frame_header));
+
+        uint64_t sample_size = sample_type_size(header.sample_type);
+        if (header.command > PLOTLIB_FRAME_FILL_POINTS || sample_size == 0) {
+            printf(ERROR "Received a frame with the unknown command '%u' or sample type '%u', closing the connection.\n",
+                   header.command, header.sample_type);
+            return false;
+        }
+        bool holds_points = header.command == PLOTLIB_FRAME_APPEND_POINTS || header.command == PLOTLIB_FRAME_FILL_POINTS;
+        uint64_t values_per_sample = holds_points ? 2 : 1;
+        if (header.count > MAX_STREAM_FRAME_SIZE / (values_per_sample * sample_size)) {
+            printf(ERROR "Received a frame of %llu samples, which is too large, closing the connection.\n", (unsigned long long) header.count);
+            return false;
+        }
+        uint64_t payload_size = (header.count * values_per_sample * sample_size + 7) & ~(uint64_t) 7;
+        if (connection.received_length - offset < sizeof(plotlib_frame_header) + payload_size) break;
 
-    uint64_t old_size = plot_update.new_points_y.size();
-    plot_update.new_points_y.resize(old_size + length);
-    for (uint64_t i = 0; i < length; ++i) {
-        plot_update.new_points_y[old_size + i] = numbers[i];
+        stage_frame(header, &connection.received[offset + sizeof(plotlib_frame_header)]);
+        offset += sizeof(plotlib_frame_header) + payload_size;
     }
-    plot_update.contains_numbers = true;
-    plot_update.empty_update = false;
 
-    gps_update_mutex.unlock();
+    connection.received_length -= offset;
+    if (connection.received_length > 0 && offset > 0) {
+        memmove(&connection.received[0], &connection.received[offset], connection.received_length);
+    }
     return true;
 }
 
-PLOTAPI bool plot_append_point(uint32_t plot_idx, double point_x, double point_y)
+static void stream_server_loop(Stream_Server* server)
 {
-    if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-    
-    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
-    if (plot_update.contains_numbers) {
-        printf(ERROR "The Plot with index '%d' contains numbers and cannot be appended with the point '(%f, %f)'.\n", plot_idx, point_x, point_y);
-        gps_update_mutex.unlock();
-        return false;
-    }
+    std::vector<pollfd> poll_fds;
+    while (true) {
+        poll_fds.clear();
+        poll_fds.push_back(pollfd{ server->wake_pipe[0], POLLIN, 0 });
+        poll_fds.push_back(pollfd{ server->listen_fd, POLLIN, 0 });
+        for (size_t i = 0; i < server->connections.size(); ++i) {
+            poll_fds.push_back(pollfd{ server->connections[i].fd, POLLIN, 0 });
+        }
 
-    plot_update.new_points_x.push_back(point_x);
-    plot_update.new_points_y.push_back(point_y);
-    plot_update.contains_points = true;
-    plot_update.empty_update = false;
+        if (poll(poll_fds.data(), poll_fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            printf(ERROR "The streaming server failed to wait for its connections: %s.\n", strerror(errno));
+            break;
+        }
+        if (poll_fds[0].revents) break;
 
-    gps_update_mutex.unlock();
-    return true;    
+        for (size_t i = server->connections.size(); i-- > 0;) {
+            if (poll_fds[2 + i].revents && !receive_frames(server->connections[i])) {
+                close(server->connections[i].fd);
+                server->connections.erase(server->connections.begin() + i);
+            }
+        }
+
+        if (poll_fds[1].revents & POLLIN) {
+            int fd = accept(server->listen_fd, nullptr, nullptr);
+            if (fd >= 0) {
+                Stream_Connection connection;
+                connection.fd = fd;
+                server->connections.push_back(std::move(connection));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < server->connections.size(); ++i) {
+        close(server->connections[i].fd);
+    }
+    server->connections.clear();
 }
 
-PLOTAPI bool plot_append_points_x_y(uint32_t plot_idx, double* points_x, double* points_y, uint64_t length)
+static int open_listen_socket(const char* socket_path)
 {
-    if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-    
-    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
-    if (plot_update.contains_numbers) {
-        printf(ERROR "The Plot with index '%d' contains numbers and cannot be appended with points.\n", plot_idx);
-        gps_update_mutex.unlock();
-        return false;
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        printf(ERROR "The socket path '%s' is too long.\n", socket_path);
+        return -1;
     }
+    strcpy(address.sun_path, socket_path);
 
-    uint64_t old_size = plot_update.new_points_y.size();
-    plot_update.new_points_x.resize(old_size + length);
-    plot_update.new_points_y.resize(old_size + length);
-    for (uint64_t i = 0; i < length; ++i) {
-        plot_update.new_points_x[old_size + i] = points_x[i];
-        plot_update.new_points_y[old_size + i] = points_y[i];
+    struct stat path_stat;
+    if (stat(socket_path, &path_stat) == 0 && S_ISSOCK(path_stat.st_mode)) {
+        unlink(socket_path); // left behind by a server which wasn't stopped
     }
-    plot_update.contains_points = true;
-    plot_update.empty_update = false;
 
-    gps_update_mutex.unlock();
-    return true;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || bind(fd, (sockaddr*) &address, sizeof(address)) != 0 || listen(fd, 16) != 0) {
+        printf(ERROR "Failed to listen on the socket '%s': %s.\n", socket_path, strerror(errno));
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
 }
+#endif
 
-PLOTAPI bool plot_append_points_xy(uint32_t plot_idx, double* points_xy, uint64_t length)
+// Starts a thread which listens on the Unix domain socket 'socket_path', other processes stream frames into the plots
+// through it without linking plotlib. See 'plotlib_frame_header' for the protocol.
+PLOTAPI bool plotlib_start_server(const char* socket_path)
 {
-    if (!valid_plot_idx(plot_idx)) return false;
-    if (length % 2 != 0) {
-        printf(ERROR "The length provided is not divisible by 2 but 'plot_append_points_xy' expects an array of Points.\n");
+#ifdef _WIN32
+    (void) socket_path;
+    printf(ERROR "The streaming server is only supported on POSIX systems.\n");
+    return false;
+#else
+    stream_server_mutex.lock();
+    if (stream_server) {
+        printf(ERROR "The streaming server is already listening on '%s'.\n", stream_server->socket_path);
+        stream_server_mutex.unlock();
         return false;
     }
-    gps_update_mutex.lock();
-    
-    Plot_Update& plot_update = gps_update.plot_updates[plot_idx];
-    if (plot_update.contains_numbers) {
-        printf(ERROR "The Plot with index '%d' contains numbers and cannot be appended with points.\n", plot_idx);
-        gps_update_mutex.unlock();
+
+    int listen_fd = open_listen_socket(socket_path);
+    int wake_pipe[2];
+    if (listen_fd < 0 || pipe(wake_pipe) != 0) {
+        if (listen_fd >= 0) {
+            printf(ERROR "Failed to create the pipe which stops the streaming server: %s.\n", strerror(errno));
+            close(listen_fd);
+            unlink(socket_path);
+        }
+        stream_server_mutex.unlock();
         return false;
     }
 
-    uint64_t old_size = plot_update.new_points_y.size();
-    plot_update.new_points_x.resize(old_size + length / 2);
-    plot_update.new_points_y.resize(old_size + length / 2);
-    for (uint64_t i = 0; i < length / 2; ++i) {
-        plot_update.new_points_x[old_size + i] = points_xy[i * 2];
-        plot_update.new_points_y[old_size + i] = points_xy[i * 2 + 1];
-    }
-    plot_update.contains_points = true;
-    plot_update.empty_update = false;
+    stream_server = new Stream_Server;
+    stream_server->listen_fd = listen_fd;
+    stream_server->wake_pipe[0] = wake_pipe[0];
+    stream_server->wake_pipe[1] = wake_pipe[1];
+    stream_server->socket_path = new char[strlen(socket_path) + 1];
+    strcpy(stream_server->socket_path, socket_path);
+    stream_server->thread = std::thread(stream_server_loop, stream_server);
 
-    gps_update_mutex.unlock();
+    stream_server_mutex.unlock();
     return true;
+#endif
+}
+
+// Closes all connections, frames which were received completely are still shown.
+PLOTAPI void plotlib_stop_server()
+{
+#ifndef _WIN32
+    stream_server_mutex.lock();
+    if (stream_server) {
+        char wake = 0;
+        if (write(stream_server->wake_pipe[1], &wake, 1) != 1) {
+            printf(ERROR "Failed to wake the streaming server: %s.\n", strerror(errno));
+        }
+        stream_server->thread.join();
+
+        close(stream_server->listen_fd);
+        close(stream_server->wake_pipe[0]);
+        close(stream_server->wake_pipe[1]);
+        unlink(stream_server->socket_path);
+        delete[] stream_server->socket_path;
+        delete stream_server;
+        stream_server = nullptr;
+    }
+    stream_server_mutex.unlock();
+#endif
 }
 
 PLOTAPI bool plotgroup_show(uint32_t plotgroup_idx)
 {
     if (!valid_group_idx(plotgroup_idx)) return false;
-    gps_update_mutex.lock();
-
-    gps_update.visible_group = plotgroup_idx;
-    gps_update.window_visible = true;
-            
-    gps_update_mutex.unlock();
-    start_gui_thread_if_not_started();
-    return true;
+    return submit([=] {
+        gps_update.visible_group = plotgroup_idx;
+        gps_update.window_visible = true;
+        start_gui_thread_if_not_started();
+        return true;
+    });
 }
 
 PLOTAPI bool plotgroup_append(uint32_t plotgroup_idx, uint32_t plot_idx)
 {
     if (!valid_group_idx(plotgroup_idx)) return false;
     if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-
-    Plot_Group_Update& group_update = gps_update.plot_group_updates[plotgroup_idx];
-
-    group_update.new_plots.push_back(plot_idx);
-    group_update.empty_update = false;
-            
-    gps_update_mutex.unlock();
-    return true;
+    return submit([=] {
+        gps_update.plot_group_updates[plotgroup_idx].new_plots.push_back(plot_idx);
+        gps_update.mark_group_dirty(plotgroup_idx);
+        return true;
+    });
 }
 
 PLOTAPI bool plotgroup_remove(uint32_t plotgroup_idx, uint32_t plot_idx)
 {
     if (!valid_group_idx(plotgroup_idx)) return false;
     if (!valid_plot_idx(plot_idx)) return false;
-    gps_update_mutex.lock();
-
-    Plot_Group_Update& group_update = gps_update.plot_group_updates[plotgroup_idx];
-
-    group_update.remove_plots.push_back(plot_idx);
-    group_update.empty_update = false;
-            
-    gps_update_mutex.unlock();
-    return true;
+    return submit([=] {
+        gps_update.plot_group_updates[plotgroup_idx].remove_plots.push_back(plot_idx);
+        gps_update.mark_group_dirty(plotgroup_idx);
+        return true;
+    });
 }
 
 PLOTAPI bool plotgroup_clear(uint32_t plotgroup_idx)
 {
     if (!valid_group_idx(plotgroup_idx)) return false;
-    gps_update_mutex.lock();
-
-    gps_update.plot_group_updates[plotgroup_idx].clear_group();
-            
-    gps_update_mutex.unlock();
-    return true;    
+    return submit([=] {
+        gps_update.plot_group_updates[plotgroup_idx].clear_group();
+        gps_update.mark_group_dirty(plotgroup_idx);
+        return true;
+    });
 }
 
 PLOTAPI bool plotgroup_set_name(uint32_t plotgroup_idx, const char* name)
 {
     if (!valid_group_idx(plotgroup_idx)) return false;
-    gps_update_mutex.lock();
-
-    Plot_Group_Update& group_update = gps_update.plot_group_updates[plotgroup_idx];
-
-    group_update.new_name = new char[strlen(name) + 1];
-    strcpy(group_update.new_name, name);
-    group_update.empty_update = false;
-            
-    gps_update_mutex.unlock();
-    return true;    
+    std::shared_ptr<char> name_copy(new char[strlen(name) + 1], std::default_delete<char[]>());
+    strcpy(name_copy.get(), name);
+    return submit([=] {
+        Plot_Group_Update& group_update = gps_update.plot_group_updates[plotgroup_idx];
+        delete[] group_update.new_name;
+        group_update.new_name = new char[strlen(name_copy.get()) + 1];
+        strcpy(group_update.new_name, name_copy.get());
+        gps_update.mark_group_dirty(plotgroup_idx);
+        return true;
+    });
 }
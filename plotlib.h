@@ -5,7 +5,41 @@
 
 #define LIBTYPE_SHARED 1
 #define PLOTLIB_MAX_PLOT_IDX (1024 - 1)
+#define PLOTLIB_MAX_PLOT_HANDLE ((1 << 20) - 1) // the largest handle 'plot_create' hands out after the fixed indices
 #define PLOTLIB_MAX_PLOT_GROUP_IDX (256 - 1)
+#define PLOTLIB_NO_IDX 0xffffffff
+
+// Policies for what happens to new values once more than the maximum are staged for a plot between two frames.
+#define PLOTLIB_STAGING_UNBOUNDED 0        // stage everything (default)
+#define PLOTLIB_STAGING_BLOCK 1            // the appending thread waits for the next frame, drops the newest while the window is hidden
+#define PLOTLIB_STAGING_DROP_OLDEST 2      // drop the oldest staged values
+#define PLOTLIB_STAGING_DROP_NEWEST 3      // drop the new values which don't fit anymore, a larger fill keeps only its first values
+#define PLOTLIB_STAGING_KEEP_LATEST_FILL 4 // like DROP_NEWEST, but fills are never cut and always replace everything staged
+
+// Policies for what the gui-thread gives back once the plots hold more memory than their limit.
+#define PLOTLIB_MEMORY_SHRINK 0        // free the unused capacity of the plots and of the staging buffers
+#define PLOTLIB_MEMORY_TRIM_LARGEST 1  // like SHRINK, then evict the oldest values of the largest plots until they fit
+
+// Types of the samples in memory which plotlib reads directly, and in which a plot can store its values.
+#define PLOTLIB_SAMPLE_F64 0
+#define PLOTLIB_SAMPLE_F32 1
+#define PLOTLIB_SAMPLE_I32 2
+#define PLOTLIB_SAMPLE_I16 3
+#define PLOTLIB_SAMPLE_U16 4
+#define PLOTLIB_SAMPLE_I64 5
+
+// Layouts of the samples in a file or a shared-memory ring.
+#define PLOTLIB_LAYOUT_NUMBERS 0    // one sample per value
+#define PLOTLIB_LAYOUT_POINTS_XY 1  // x and y of a point are two consecutive samples
+#define PLOTLIB_LAYOUT_POINTS_X_Y 2 // all x values followed by all y values, only for files
+
+#define PLOTLIB_SHM_MAGIC 0x544f4c50 // "PLOT"
+
+// Commands of a frame sent to the streaming server.
+#define PLOTLIB_FRAME_APPEND_NUMBERS 0
+#define PLOTLIB_FRAME_APPEND_POINTS 1 // x and y of a point are two consecutive samples
+#define PLOTLIB_FRAME_FILL_NUMBERS 2
+#define PLOTLIB_FRAME_FILL_POINTS 3
 
 #ifdef LIBTYPE_SHARED
     #ifdef _WIN32
@@ -23,6 +57,50 @@
 extern "C" {
 #endif
 
+typedef void (*plotlib_release_fn)(void* user_data);
+
+// Header at the start of a POSIX shared-memory object which 'plot_attach_shm' consumes, the data region follows directly
+// after it. The writer stores sample 'i' (point 'i' for PLOTLIB_LAYOUT_POINTS_XY) at index 'i % capacity' of the data
+// region and then publishes it by storing 'i + 1' into 'write_cursor' with release semantics, e.g. with
+// '__atomic_store_n(&header->write_cursor, i + 1, __ATOMIC_RELEASE)'. The writer must publish every sample before it writes
+// the next one, so only the slot of sample 'write_cursor' can be written while it isn't published. The gui-thread therefore
+// reads at most the newest 'capacity - 1' samples, and drops those which the writer could have overwritten while it copied
+// them, by reading 'write_cursor' again afterwards. The capacity has to be at least 2.
+typedef struct plotlib_shm_header {
+    uint32_t magic;       // PLOTLIB_SHM_MAGIC, write it last when initializing the header
+    uint32_t sample_type; // one of the PLOTLIB_SAMPLE_* types
+    uint32_t layout;      // PLOTLIB_LAYOUT_NUMBERS or PLOTLIB_LAYOUT_POINTS_XY
+    uint32_t reserved;
+    uint64_t capacity;    // number of values (or points) the data region holds
+    uint8_t padding_0[40];
+    uint64_t write_cursor; // number of values (or points) written so far, on its own cache line
+    uint8_t padding_1[56];
+} plotlib_shm_header;
+
+// A frame on the socket of 'plotlib_start_server' is this header followed by 'count' values (or points) of 'sample_type'
+// in native byte order. The payload is padded with zeros to a multiple of 8 bytes.
+typedef struct plotlib_frame_header {
+    uint32_t plot_idx;
+    uint16_t command;     // one of the PLOTLIB_FRAME_* commands
+    uint16_t sample_type; // one of the PLOTLIB_SAMPLE_* types
+    uint64_t count;
+} plotlib_frame_header;
+
+// The memory of a plot, or of all plots, in bytes.
+typedef struct plotlib_memory_usage {
+    uint64_t live_bytes;     // the values the plot holds, as they are stored
+    uint64_t capacity_bytes; // the memory holding them in RAM, including unused capacity but without spilled values
+    uint64_t staged_bytes;   // the values staged for the next frame and the capacity of the staging buffers
+} plotlib_memory_usage;
+
+// The bounding box of a range of values of a plot.
+typedef struct plotlib_bounds {
+    double x_min;
+    double x_max;
+    double y_min; // greater than 'y_max' if the values are all NaN
+    double y_max;
+} plotlib_bounds;
+
 PLOTAPI void plotlib_show();
 PLOTAPI void plotlib_hide();
 PLOTAPI void plotlib_dark_theme();
@@ -33,7 +111,19 @@ PLOTAPI void plotlib_mode_show_x_range_of_tail(double x_range);
 PLOTAPI void plotlib_mode_fill_window();
 PLOTAPI bool plotlib_mode_show_specific_plot(uint32_t plot_idx);
 PLOTAPI void plotlib_clear_all_plots();
+PLOTAPI bool plotlib_begin_batch();
+PLOTAPI bool plotlib_commit();
+PLOTAPI bool plotlib_set_staging_limit(uint32_t policy, uint64_t max_staged_values);
+PLOTAPI uint64_t plotlib_get_dropped_count();
+PLOTAPI bool plotlib_set_spill_limit(uint64_t max_resident_bytes, const char* directory);
+PLOTAPI bool plotlib_set_memory_limit(uint64_t max_bytes, uint32_t policy);
+PLOTAPI bool plotlib_get_memory_usage(plotlib_memory_usage* usage);
+PLOTAPI bool plotlib_start_server(const char* socket_path);
+PLOTAPI void plotlib_stop_server();
+PLOTAPI bool plotlib_load_csv(const char* path, const uint32_t* column_plots, uint32_t column_count, uint32_t x_column);
 
+PLOTAPI uint32_t plot_create(const char* name);
+PLOTAPI uint32_t plot_find(const char* name);
 PLOTAPI bool plot_show(uint32_t plot_idx);
 PLOTAPI bool plot_hide(uint32_t plot_idx);
 PLOTAPI void plot_hide_all();
@@ -51,6 +141,40 @@ PLOTAPI bool plot_append_numbers(uint32_t plot_idx, double* numbers, uint64_t le
 PLOTAPI bool plot_append_point(uint32_t plot_idx, double point_x, double point_y);
 PLOTAPI bool plot_append_points_x_y(uint32_t plot_idx, double* points_x, double* points_y, uint64_t length);
 PLOTAPI bool plot_append_points_xy(uint32_t plot_idx, double* points_xy, uint64_t length);
+PLOTAPI bool plot_fill_numbers_typed(uint32_t plot_idx, const void* numbers, uint32_t sample_type, uint64_t length);
+PLOTAPI bool plot_fill_points_x_y_typed(uint32_t plot_idx, const void* points_x, const void* points_y, uint32_t sample_type, uint64_t length);
+PLOTAPI bool plot_append_numbers_typed(uint32_t plot_idx, const void* numbers, uint32_t sample_type, uint64_t length);
+PLOTAPI bool plot_append_points_x_y_typed(uint32_t plot_idx, const void* points_x, const void* points_y, uint32_t sample_type, uint64_t length);
+PLOTAPI bool plot_fill_numbers_strided(uint32_t plot_idx, const void* numbers, uint64_t stride, uint32_t sample_type, uint64_t length);
+PLOTAPI bool plot_fill_points_strided(uint32_t plot_idx, const void* points_x, uint64_t x_stride, const void* points_y, uint64_t y_stride, uint32_t sample_type, uint64_t length);
+PLOTAPI bool plot_append_numbers_strided(uint32_t plot_idx, const void* numbers, uint64_t stride, uint32_t sample_type, uint64_t length);
+PLOTAPI bool plot_append_points_strided(uint32_t plot_idx, const void* points_x, uint64_t x_stride, const void* points_y, uint64_t y_stride, uint32_t sample_type, uint64_t length);
+PLOTAPI bool plot_set_storage(uint32_t plot_idx, uint32_t sample_type, double scale, double offset);
+PLOTAPI bool plot_fill_timestamped(uint32_t plot_idx, const int64_t* timestamps_ns, const double* values, uint64_t length);
+PLOTAPI bool plot_append_timestamped(uint32_t plot_idx, const int64_t* timestamps_ns, const double* values, uint64_t length);
+PLOTAPI bool plot_set_retention_count(uint32_t plot_idx, uint64_t max_count);
+PLOTAPI bool plot_set_retention_x_range(uint32_t plot_idx, double x_range);
+PLOTAPI bool plot_set_compression(uint32_t plot_idx, bool enabled);
+PLOTAPI bool plot_set_implicit_x(uint32_t plot_idx, double x0, double dx);
+PLOTAPI bool plot_fill_numbers_borrowed(uint32_t plot_idx, const double* numbers, uint64_t length, plotlib_release_fn release, void* user_data);
+PLOTAPI bool plot_fill_points_x_y_borrowed(uint32_t plot_idx, const double* points_x, const double* points_y, uint64_t length, plotlib_release_fn release, void* user_data);
+PLOTAPI bool plot_append_numbers_borrowed(uint32_t plot_idx, const double* numbers, uint64_t length, plotlib_release_fn release, void* user_data);
+PLOTAPI bool plot_append_points_x_y_borrowed(uint32_t plot_idx, const double* points_x, const double* points_y, uint64_t length, plotlib_release_fn release, void* user_data);
+// Only one thread may append to the plot after this call, the ring has a single producer and two would corrupt its values.
+// The appends never block, they fail if the ring is full.
+PLOTAPI bool plot_enable_append_ring(uint32_t plot_idx, uint64_t capacity);
+PLOTAPI bool plot_set_staging_limit(uint32_t plot_idx, uint32_t policy, uint64_t max_staged_values);
+PLOTAPI uint64_t plot_get_dropped_count(uint32_t plot_idx);
+PLOTAPI bool plot_get_memory_usage(uint32_t plot_idx, plotlib_memory_usage* usage);
+// The values [begin, end) count from the oldest value the plot holds, as of the last frame. Both are answered in O(log n),
+// but they wait while the gui-thread applies the updates and draws a frame, so a call can take up to a frame.
+PLOTAPI bool plot_range_bounds(uint32_t plot_idx, uint64_t begin, uint64_t end, plotlib_bounds* bounds);
+// Writes up to 'max_crossings' indices at which the values cross 'level' into 'crossings' and returns their count.
+PLOTAPI uint64_t plot_find_threshold_crossings(uint32_t plot_idx, double level, uint64_t begin, uint64_t end, uint64_t* crossings, uint64_t max_crossings);
+PLOTAPI bool plot_attach_shm(uint32_t plot_idx, const char* shm_name, uint32_t layout);
+PLOTAPI bool plot_detach_shm(uint32_t plot_idx);
+PLOTAPI bool plot_load_npy(uint32_t plot_idx, const char* path);
+PLOTAPI bool plot_load_raw(uint32_t plot_idx, const char* path, uint32_t sample_type, uint32_t layout);
     
 PLOTAPI bool plotgroup_show(uint32_t plotgroup_idx);
 PLOTAPI bool plotgroup_append(uint32_t plotgroup_idx, uint32_t plot_idx);
@@ -8,7 +8,52 @@ else
 end
 
 const MAX_PLOT_IDX = 1024 - 1
+const MAX_PLOT_HANDLE = 2^20 - 1
 const MAX_PLOT_GROUP_IDX = 256 - 1
+const NO_IDX = 0xffffffff
+
+const STAGING_UNBOUNDED = 0
+const STAGING_BLOCK = 1
+const STAGING_DROP_OLDEST = 2
+const STAGING_DROP_NEWEST = 3
+const STAGING_KEEP_LATEST_FILL = 4
+
+const MEMORY_SHRINK = 0
+const MEMORY_TRIM_LARGEST = 1
+
+const SAMPLE_F64 = 0
+const SAMPLE_F32 = 1
+const SAMPLE_I32 = 2
+const SAMPLE_I16 = 3
+const SAMPLE_U16 = 4
+const SAMPLE_I64 = 5
+
+const Sample = Union{Float32, Int32, Int16, UInt16, Int64}
+sample_type(::Type{Float64}) = SAMPLE_F64
+sample_type(::Type{Float32}) = SAMPLE_F32
+sample_type(::Type{Int32}) = SAMPLE_I32
+sample_type(::Type{Int16}) = SAMPLE_I16
+sample_type(::Type{UInt16}) = SAMPLE_U16
+sample_type(::Type{Int64}) = SAMPLE_I64
+
+const LAYOUT_NUMBERS = 0
+const LAYOUT_POINTS_XY = 1
+const LAYOUT_POINTS_X_Y = 2
+
+"The memory of a plot, or of all plots, in bytes, see 'plotlib_memory_usage' in plotlib.h."
+struct MemoryUsage
+    live_bytes::UInt64
+    capacity_bytes::UInt64
+    staged_bytes::UInt64
+end
+
+"The bounding box of a range of values of a plot, see 'plotlib_bounds' in plotlib.h."
+struct Bounds
+    x_min::Float64
+    x_max::Float64
+    y_min::Float64
+    y_max::Float64
+end
 
 struct Color
     r::UInt8
@@ -90,6 +135,90 @@ function clear_all_plots()::Nothing
     @ccall plotlib.plotlib_clear_all_plots()::Cvoid;
 end
 
+"""
+Records all following calls of the current thread instead of applying them, until 'commit' applies all of them at once.
+Everything in a batch becomes visible in the same frame, appends to plots with an append ring are pushed into it on commit.
+"""
+function begin_batch()::Bool
+    @ccall plotlib.plotlib_begin_batch()::Bool
+end
+
+function commit()::Bool
+    @ccall plotlib.plotlib_commit()::Bool
+end
+
+"""
+Limits how many values can be staged for every plot between two frames, what happens to values beyond that depends on the policy:
+STAGING_UNBOUNDED stages everything, STAGING_BLOCK makes the appending thread wait for the next frame,
+STAGING_DROP_OLDEST and STAGING_DROP_NEWEST drop values (a fill larger than the limit keeps only its first values with
+STAGING_DROP_NEWEST), STAGING_KEEP_LATEST_FILL drops appends but always accepts fills whole.
+"""
+function set_staging_limit(policy, max_staged_values)::Bool
+    @ccall plotlib.plotlib_set_staging_limit(policy::UInt32, max_staged_values::UInt64)::Bool
+end
+
+"The number of values dropped by staging limits and full append rings of all plots."
+function dropped_count()::UInt64
+    @ccall plotlib.plotlib_get_dropped_count()::UInt64
+end
+
+"""
+Once the storage of all plots exceeds 'max_resident_bytes', the oldest values of large plots are moved into files in 'directory'
+(\$TMPDIR or /tmp by default), they are only read in again when they are shown. 0 keeps everything in memory.
+"""
+function set_spill_limit(max_resident_bytes, directory=get(ENV, "TMPDIR", "/tmp"))::Bool
+    @ccall plotlib.plotlib_set_spill_limit(max_resident_bytes::UInt64, directory::Cstring)::Bool
+end
+
+"""
+Once the plots hold more than 'max_bytes', MEMORY_SHRINK frees their unused capacity and MEMORY_TRIM_LARGEST then also evicts
+the oldest values of the largest plots until they fit. 0 is unlimited.
+"""
+function set_memory_limit(max_bytes, policy=MEMORY_TRIM_LARGEST)::Bool
+    @ccall plotlib.plotlib_set_memory_limit(max_bytes::UInt64, policy::UInt32)::Bool
+end
+
+"The memory of all plots."
+function memory_usage()::MemoryUsage
+    usage = Ref{MemoryUsage}(MemoryUsage(0, 0, 0))
+    @ccall plotlib.plotlib_get_memory_usage(usage::Ptr{MemoryUsage})::Bool
+    return usage[]
+end
+
+"Starts listening for frames of other processes on the Unix domain socket 'socket_path', see the README for the protocol."
+function start_server(socket_path)::Bool
+    @ccall plotlib.plotlib_start_server(socket_path::Cstring)::Bool
+end
+
+function stop_server()
+    @ccall plotlib.plotlib_stop_server()::Cvoid
+end
+
+"""
+Loads the columns of a CSV file into plots, 'column_plots[i]' is the plot index for column i or nothing to skip it.
+If 'x_column' is given, its values are the x coordinates of all other loaded columns.
+"""
+function load_csv(path, column_plots; x_column=nothing)::Bool
+    plots = UInt32[plot_idx === nothing ? NO_IDX : plot_idx for plot_idx in column_plots]
+    x = x_column === nothing ? NO_IDX : UInt32(x_column - 1)
+    @ccall plotlib.plotlib_load_csv(path::Cstring, plots::Ptr{UInt32}, length(plots)::UInt32, x::UInt32)::Bool
+end
+
+"""
+Returns the handle of the plot named 'name', it is created if there is none yet. Handles are plot indices after MAX_PLOT_IDX
+and can be passed to every function which takes a plot index.
+"""
+function create_plot(name)::Union{UInt32, Nothing}
+    plot_idx = @ccall plotlib.plot_create(name::Cstring)::UInt32
+    return plot_idx == NO_IDX ? nothing : plot_idx
+end
+
+"The handle of the plot which create_plot created with 'name', or nothing."
+function find_plot(name)::Union{UInt32, Nothing}
+    plot_idx = @ccall plotlib.plot_find(name::Cstring)::UInt32
+    return plot_idx == NO_IDX ? nothing : plot_idx
+end
+
 function show(plot_idx)::Bool
     @ccall plotlib.plot_show(plot_idx::UInt32)::Bool
 end
@@ -167,6 +296,263 @@ function append_points_xy(plot_idx, points_xy::Vector{Float64})::Bool
     @ccall plotlib.plot_append_points_xy(plot_idx::UInt32, points_xy::Ptr{Float64}, length(points_xy)::UInt64)::Bool
 end
 
+# Vectors of other sample types are passed as they are, plotlib converts them.
+
+function fill_numbers(plot_idx, numbers::Vector{T})::Bool where T <: Sample
+    @ccall plotlib.plot_fill_numbers_typed(plot_idx::UInt32, numbers::Ptr{Cvoid}, sample_type(T)::UInt32, length(numbers)::UInt64)::Bool
+end
+
+function fill_points_x_y(plot_idx, points_x::Vector{T}, points_y::Vector{T})::Bool where T <: Sample
+    if length(points_x) != length(points_y)
+        println("PLOTLIB ERROR: The length of 'points_x' and 'points_y' must match.")
+        return false
+    end
+    @ccall plotlib.plot_fill_points_x_y_typed(plot_idx::UInt32, points_x::Ptr{Cvoid}, points_y::Ptr{Cvoid}, sample_type(T)::UInt32, length(points_y)::UInt64)::Bool
+end
+
+function append_numbers(plot_idx, numbers::Vector{T})::Bool where T <: Sample
+    @ccall plotlib.plot_append_numbers_typed(plot_idx::UInt32, numbers::Ptr{Cvoid}, sample_type(T)::UInt32, length(numbers)::UInt64)::Bool
+end
+
+function append_points_x_y(plot_idx, points_x::Vector{T}, points_y::Vector{T})::Bool where T <: Sample
+    if length(points_x) != length(points_y)
+        println("PLOTLIB ERROR: The length of 'points_x' and 'points_y' must match.")
+        return false
+    end
+    @ccall plotlib.plot_append_points_x_y_typed(plot_idx::UInt32, points_x::Ptr{Cvoid}, points_y::Ptr{Cvoid}, sample_type(T)::UInt32, length(points_y)::UInt64)::Bool
+end
+
+"""
+Plots 'values' against int64 nanosecond timestamps, e.g. since the unix epoch. The x axis is labeled with UTC times, x values
+are seconds relative to the first timestamp plotted. The plot stays timestamped until it is cleared or filled with other
+values, other points can't be appended to it until then.
+"""
+function fill_timestamped(plot_idx, timestamps_ns::Vector{Int64}, values::Vector{Float64})::Bool
+    if length(timestamps_ns) != length(values)
+        println("PLOTLIB ERROR: The length of 'timestamps_ns' and 'values' must match.")
+        return false
+    end
+    @ccall plotlib.plot_fill_timestamped(plot_idx::UInt32, timestamps_ns::Ptr{Int64}, values::Ptr{Float64}, length(values)::UInt64)::Bool
+end
+
+function append_timestamped(plot_idx, timestamps_ns::Vector{Int64}, values::Vector{Float64})::Bool
+    if length(timestamps_ns) != length(values)
+        println("PLOTLIB ERROR: The length of 'timestamps_ns' and 'values' must match.")
+        return false
+    end
+    @ccall plotlib.plot_append_timestamped(plot_idx::UInt32, timestamps_ns::Ptr{Int64}, values::Ptr{Float64}, length(values)::UInt64)::Bool
+end
+
+# The field of every struct in 'records', as a pointer to the first one and the sample type.
+function field_samples(records::Vector{T}, field::Symbol) where T
+    i = findfirst(==(field), fieldnames(T))
+    return Ptr{Cvoid}(pointer(records)) + fieldoffset(T, i), sample_type(fieldtype(T, i))
+end
+
+"Plots the field 'field' of every struct in 'records' without gathering them first, e.g. fill_numbers_strided(1, samples, :voltage)."
+function fill_numbers_strided(plot_idx, records::Vector{T}, field::Symbol)::Bool where T
+    GC.@preserve records begin
+        numbers, type = field_samples(records, field)
+        @ccall plotlib.plot_fill_numbers_strided(plot_idx::UInt32, numbers::Ptr{Cvoid}, Base.elsize(records)::UInt64, type::UInt32, length(records)::UInt64)::Bool
+    end
+end
+
+"Like fill_numbers_strided for points, both fields must have the same type."
+function fill_points_strided(plot_idx, records::Vector{T}, x_field::Symbol, y_field::Symbol)::Bool where T
+    GC.@preserve records begin
+        points_x, x_type = field_samples(records, x_field)
+        points_y, y_type = field_samples(records, y_field)
+        if x_type != y_type
+            println("PLOTLIB ERROR: The fields '$x_field' and '$y_field' must have the same type.")
+            return false
+        end
+        stride = Base.elsize(records)
+        @ccall plotlib.plot_fill_points_strided(plot_idx::UInt32, points_x::Ptr{Cvoid}, stride::UInt64, points_y::Ptr{Cvoid}, stride::UInt64, x_type::UInt32, length(records)::UInt64)::Bool
+    end
+end
+
+function append_numbers_strided(plot_idx, records::Vector{T}, field::Symbol)::Bool where T
+    GC.@preserve records begin
+        numbers, type = field_samples(records, field)
+        @ccall plotlib.plot_append_numbers_strided(plot_idx::UInt32, numbers::Ptr{Cvoid}, Base.elsize(records)::UInt64, type::UInt32, length(records)::UInt64)::Bool
+    end
+end
+
+function append_points_strided(plot_idx, records::Vector{T}, x_field::Symbol, y_field::Symbol)::Bool where T
+    GC.@preserve records begin
+        points_x, x_type = field_samples(records, x_field)
+        points_y, y_type = field_samples(records, y_field)
+        if x_type != y_type
+            println("PLOTLIB ERROR: The fields '$x_field' and '$y_field' must have the same type.")
+            return false
+        end
+        stride = Base.elsize(records)
+        @ccall plotlib.plot_append_points_strided(plot_idx::UInt32, points_x::Ptr{Cvoid}, stride::UInt64, points_y::Ptr{Cvoid}, stride::UInt64, x_type::UInt32, length(records)::UInt64)::Bool
+    end
+end
+
+"""
+The plot stores its y values as 'sample_type' (SAMPLE_*), a stored sample 's' is the value 's * scale + offset'.
+Integer samples are rounded and clamped, e.g. SAMPLE_I16 with scale 0.001 holds values from -32.768 to 32.767 in 2 bytes.
+"""
+function set_storage(plot_idx, sample_type; scale=1.0, offset=0.0)::Bool
+    @ccall plotlib.plot_set_storage(plot_idx::UInt32, sample_type::UInt32, scale::Float64, offset::Float64)::Bool
+end
+
+"""
+The plot keeps only its last 'max_count' values, older ones are dropped every frame. 0 keeps all values.
+"""
+function set_retention_count(plot_idx, max_count)::Bool
+    @ccall plotlib.plot_set_retention_count(plot_idx::UInt32, max_count::UInt64)::Bool
+end
+
+"""
+The plot keeps only the values whose x is within 'x_range' of the x of its newest value, older ones are dropped every frame.
+0 keeps all values.
+"""
+function set_retention_x_range(plot_idx, x_range)::Bool
+    @ccall plotlib.plot_set_retention_x_range(plot_idx::UInt32, x_range::Float64)::Bool
+end
+
+"""
+The values of a large plot which are no longer appended to are compressed, they are decompressed when they are shown.
+Only Float64 values and timestamps are compressed.
+"""
+function set_compression(plot_idx, enabled)::Bool
+    @ccall plotlib.plot_set_compression(plot_idx::UInt32, enabled::Bool)::Bool
+end
+
+"""
+The numbers of the plot are shown at 'x0 + i * dx' instead of at their indices 'i', e.g. the times of uniformly sampled data.
+Points with uniformly spaced x values are detected and stored without their x values.
+"""
+function set_implicit_x(plot_idx, x0, dx)::Bool
+    @ccall plotlib.plot_set_implicit_x(plot_idx::UInt32, x0::Float64, dx::Float64)::Bool
+end
+
+# Arrays lent to plotlib by the borrowed functions are kept alive here until plotlib releases them.
+const borrowed_arrays = Dict{UInt, Any}()
+const borrowed_arrays_lock = ReentrantLock()
+const borrowed_arrays_next_key = Ref{UInt}(1)
+
+function release_borrowed_array(key::Ptr{Cvoid})::Cvoid
+    lock(borrowed_arrays_lock) do
+        delete!(borrowed_arrays, UInt(key))
+    end
+    return nothing
+end
+
+function borrow_arrays(arrays...)::Ptr{Cvoid}
+    lock(borrowed_arrays_lock) do
+        key = borrowed_arrays_next_key[]
+        borrowed_arrays_next_key[] += 1
+        borrowed_arrays[key] = arrays
+        return Ptr{Cvoid}(key)
+    end
+end
+
+"""
+Like fill_numbers, but plotlib references 'numbers' instead of copying it. Don't mutate it afterwards.
+The release callback comes from the GUI thread, this needs Julia 1.9 or newer.
+"""
+function fill_numbers_borrowed(plot_idx, numbers::Vector{Float64})::Bool
+    release = @cfunction(release_borrowed_array, Cvoid, (Ptr{Cvoid},))
+    @ccall plotlib.plot_fill_numbers_borrowed(plot_idx::UInt32, numbers::Ptr{Float64}, length(numbers)::UInt64,
+                                              release::Ptr{Cvoid}, borrow_arrays(numbers)::Ptr{Cvoid})::Bool
+end
+
+function fill_points_x_y_borrowed(plot_idx, points_x::Vector{Float64}, points_y::Vector{Float64})::Bool
+    if length(points_x) != length(points_y)
+        println("PLOTLIB ERROR: The length of 'points_x' and 'points_y' must match.")
+        return false
+    end
+    release = @cfunction(release_borrowed_array, Cvoid, (Ptr{Cvoid},))
+    @ccall plotlib.plot_fill_points_x_y_borrowed(plot_idx::UInt32, points_x::Ptr{Float64}, points_y::Ptr{Float64}, length(points_y)::UInt64,
+                                                 release::Ptr{Cvoid}, borrow_arrays(points_x, points_y)::Ptr{Cvoid})::Bool
+end
+
+function append_numbers_borrowed(plot_idx, numbers::Vector{Float64})::Bool
+    release = @cfunction(release_borrowed_array, Cvoid, (Ptr{Cvoid},))
+    @ccall plotlib.plot_append_numbers_borrowed(plot_idx::UInt32, numbers::Ptr{Float64}, length(numbers)::UInt64,
+                                                release::Ptr{Cvoid}, borrow_arrays(numbers)::Ptr{Cvoid})::Bool
+end
+
+function append_points_x_y_borrowed(plot_idx, points_x::Vector{Float64}, points_y::Vector{Float64})::Bool
+    if length(points_x) != length(points_y)
+        println("PLOTLIB ERROR: The length of 'points_x' and 'points_y' must match.")
+        return false
+    end
+    release = @cfunction(release_borrowed_array, Cvoid, (Ptr{Cvoid},))
+    @ccall plotlib.plot_append_points_x_y_borrowed(plot_idx::UInt32, points_x::Ptr{Float64}, points_y::Ptr{Float64}, length(points_y)::UInt64,
+                                                   release::Ptr{Cvoid}, borrow_arrays(points_x, points_y)::Ptr{Cvoid})::Bool
+end
+
+"""
+Lets the append functions of the plot write into a lock-free ring of 'capacity' values, which the GUI drains every frame.
+Only one thread may append to the plot afterwards. Appends never block, they fail if the ring is full.
+"""
+function enable_append_ring(plot_idx, capacity)::Bool
+    @ccall plotlib.plot_enable_append_ring(plot_idx::UInt32, capacity::UInt64)::Bool
+end
+
+"Overrides the global staging limit for this plot."
+function set_staging_limit(plot_idx, policy, max_staged_values)::Bool
+    @ccall plotlib.plot_set_staging_limit(plot_idx::UInt32, policy::UInt32, max_staged_values::UInt64)::Bool
+end
+
+function dropped_count(plot_idx)::UInt64
+    @ccall plotlib.plot_get_dropped_count(plot_idx::UInt32)::UInt64
+end
+
+function memory_usage(plot_idx)::MemoryUsage
+    usage = Ref{MemoryUsage}(MemoryUsage(0, 0, 0))
+    @ccall plotlib.plot_get_memory_usage(plot_idx::UInt32, usage::Ptr{MemoryUsage})::Bool
+    return usage[]
+end
+
+"""
+The bounding box of the values 'range' of the plot, counted from 1 at the oldest value it holds as of the last frame.
+Returns 'nothing' if the range exceeds the plot. Like 'threshold_crossings', it waits while the GUI draws, up to a frame.
+"""
+function range_bounds(plot_idx, range::UnitRange)
+    bounds = Ref{Bounds}(Bounds(0, 0, 0, 0))
+    ok = @ccall plotlib.plot_range_bounds(plot_idx::UInt32, (first(range) - 1)::UInt64, last(range)::UInt64, bounds::Ptr{Bounds})::Bool
+    return ok ? bounds[] : nothing
+end
+
+"The indices within 'range' at which the values of the plot cross 'level', at most 'max_crossings' of them."
+function threshold_crossings(plot_idx, level, range::UnitRange; max_crossings=1024)::Vector{Int}
+    crossings = Vector{UInt64}(undef, max_crossings)
+    count = @ccall plotlib.plot_find_threshold_crossings(plot_idx::UInt32, level::Float64, (first(range) - 1)::UInt64, last(range)::UInt64,
+                                                         crossings::Ptr{UInt64}, max_crossings::UInt64)::UInt64
+    return Int.(crossings[1:count]) .+ 1
+end
+
+"""
+Appends the samples another process writes into the POSIX shared-memory ring 'shm_name' to the plot every frame.
+The layout of the ring is described by 'plotlib_shm_header' in plotlib.h, 'layout' is LAYOUT_NUMBERS or LAYOUT_POINTS_XY.
+"""
+function attach_shm(plot_idx, shm_name, layout=LAYOUT_NUMBERS)::Bool
+    @ccall plotlib.plot_attach_shm(plot_idx::UInt32, shm_name::Cstring, layout::UInt32)::Bool
+end
+
+function detach_shm(plot_idx)::Bool
+    @ccall plotlib.plot_detach_shm(plot_idx::UInt32)::Bool
+end
+
+"""
+Fills the plot with the array in a .npy file. Float64 data is shown straight from the mapped file instead of being read
+into memory, other data types are converted. Numbers are one dimensional arrays, points have a dimension of length 2.
+"""
+function load_npy(plot_idx, path)::Bool
+    @ccall plotlib.plot_load_npy(plot_idx::UInt32, path::Cstring)::Bool
+end
+
+"Like load_npy for a file which only contains samples of 'sample_type' (SAMPLE_*) in 'layout' (LAYOUT_*)."
+function load_raw(plot_idx, path, sample_type=SAMPLE_F64, layout=LAYOUT_NUMBERS)::Bool
+    @ccall plotlib.plot_load_raw(plot_idx::UInt32, path::Cstring, sample_type::UInt32, layout::UInt32)::Bool
+end
+
 function show_group(plotgroup_idx)::Bool
     @ccall plotlib.plotgroup_show(plotgroup_idx::UInt32)::Bool
 end